@@ -0,0 +1,560 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Block-structured adaptive mesh refinement with two levels.
+ *
+ *  The domain is divided into blocks of coarse cells. Blocks around
+ *  shocks, steep gradients and wet/dry fronts are refined by a fixed
+ *  ratio. Consecutive refined blocks form a patch, each solved by its own
+ *  WavePropagation with ratio sub-steps per coarse time step. The net
+ *  updates of the coarse cells next to a patch are corrected with the
+ *  fine net updates at the interface (refluxing) and the coarse cells
+ *  covered by a patch are replaced by the average of the fine cells.
+ *
+ *  Provides the same interface as WavePropagation, so it can be used with
+ *  Simulator.
+ */
+
+#ifndef ADAPTIVEWAVEPROPAGATION_H_
+#define ADAPTIVEWAVEPROPAGATION_H_
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "types.h"
+#include "WavePropagation.h"
+#include "solvers/FWave.hpp"
+
+class AdaptiveWavePropagation
+{
+private:
+	/** Consecutive refined blocks */
+	struct Patch
+	{
+		/** First coarse cell (incl. ghost cells) */
+		unsigned int begin;
+		/** Last coarse cell + 1 */
+		unsigned int end;
+		/** Solver for the fine cells */
+		WavePropagation *solver;
+
+		/** Coarse neighbours at the beginning of the time step (h, hu) */
+		T leftOld[2], rightOld[2];
+		/** Coarse neighbours at the end of the time step (h, hu) */
+		T leftNew[2], rightNew[2];
+
+		/** Coarse net updates at the interfaces (h, hu) */
+		T coarseLeft[2], coarseRight[2];
+		/** Sum of the fine net updates at the interfaces (h, hu) */
+		T fineLeft[2], fineRight[2];
+	};
+
+	/** Coarse unknowns, size + 2 (incl. ghost cells) */
+	T *m_h;
+	T *m_hu;
+	T *m_b;
+
+	/** Number of coarse cells */
+	const unsigned int m_size;
+	const T m_cellSize;
+
+	/** Refinement ratio */
+	const unsigned int m_ratio;
+	/** Coarse cells per block */
+	const unsigned int m_blockSize;
+	/** Relative jump above which an edge is refined */
+	const T m_refineTol;
+	/** Number of coarse time steps between two regrids */
+	const unsigned int m_regridInterval;
+
+	WavePropagation m_coarse;
+	WavePropagation::Kernel m_kernel;
+
+	/** Fine unknowns on the whole domain, only valid in refined blocks */
+	std::vector<T> m_fineH;
+	std::vector<T> m_fineHu;
+	std::vector<T> m_fineB;
+
+	/** Refinement flag of each block */
+	std::vector<bool> m_refined;
+	std::vector<Patch> m_patches;
+
+	/** Coarse time steps since the last regrid */
+	unsigned int m_stepsSinceRegrid;
+
+public:
+	/**
+	 * @param h coarse water heights, size + 2
+	 * @param hu coarse momentums, size + 2
+	 * @param b coarse bathymetry, size + 2
+	 * @param size number of coarse cells
+	 * @param cellSize size of a coarse cell
+	 * @param ratio refinement ratio
+	 * @param blockSize coarse cells per block
+	 * @param refineTol an edge is refined if the jump in surface elevation
+	 *  exceeds refineTol * h or the jump in velocity exceeds
+	 *  refineTol * sqrt(g*h)
+	 * @param regridInterval coarse time steps between two regrids, should
+	 *  not exceed blockSize (fronts move less than one cell per step)
+	 */
+	AdaptiveWavePropagation(T *h, T *hu, T *b, unsigned int size, T cellSize,
+			unsigned int ratio = 4, unsigned int blockSize = 16,
+			T refineTol = 0.01, unsigned int regridInterval = 8)
+		: m_h(h), m_hu(hu), m_b(b),
+		  m_size(size), m_cellSize(cellSize),
+		  m_ratio(ratio), m_blockSize(blockSize),
+		  m_refineTol(refineTol), m_regridInterval(std::min(regridInterval, blockSize)),
+		  m_coarse(h, hu, b, size, cellSize),
+		  m_kernel(WavePropagation::KernelFWave),
+		  m_fineH(size*ratio + 2), m_fineHu(size*ratio + 2), m_fineB(size*ratio + 2),
+		  m_refined((size + blockSize - 1) / blockSize, false),
+		  m_stepsSinceRegrid(0)
+	{
+		regrid();
+	}
+
+	~AdaptiveWavePropagation()
+	{
+		clearPatches();
+	}
+
+	void setKernel(WavePropagation::Kernel kernel)
+	{
+		m_kernel = kernel;
+		m_coarse.setKernel(kernel);
+		for (unsigned int p = 0; p < m_patches.size(); p++)
+			m_patches[p].solver->setKernel(kernel);
+	}
+
+	void setOutflowBoundaryConditions()
+	{
+		m_coarse.setOutflowBoundaryConditions();
+	}
+
+	/**
+	 * See WavePropagation::setBoundary()
+	 */
+	void setBoundary(tools::Boundary::Side side, const tools::Boundary &boundary)
+	{
+		m_coarse.setBoundary(side, boundary);
+	}
+
+	void setBoundaryConditions(T time)
+	{
+		m_coarse.setBoundaryConditions(time);
+	}
+
+	/**
+	 * Computes the net updates on the coarse level and the first fine
+	 * sub-step.
+	 *
+	 * @return Maximum allowed coarse time step (CFL condition on both levels)
+	 */
+	T computeNumericalFluxes()
+	{
+		T maxTimeStep = m_coarse.computeNumericalFluxes();
+
+		for (unsigned int p = 0; p < m_patches.size(); p++) {
+			Patch &patch = m_patches[p];
+
+			T dummy;
+			m_coarse.getNetUpdates(patch.begin-1, patch.coarseLeft[0], dummy, patch.coarseLeft[1], dummy);
+			m_coarse.getNetUpdates(patch.end-1, dummy, patch.coarseRight[0], dummy, patch.coarseRight[1]);
+
+			patch.leftOld[0] = m_h[patch.begin-1];
+			patch.leftOld[1] = m_hu[patch.begin-1];
+			patch.rightOld[0] = m_h[patch.end];
+			patch.rightOld[1] = m_hu[patch.end];
+			// Not known until the coarse update
+			std::copy(patch.leftOld, patch.leftOld+2, patch.leftNew);
+			std::copy(patch.rightOld, patch.rightOld+2, patch.rightNew);
+			patch.fineLeft[0] = patch.fineLeft[1] = 0;
+			patch.fineRight[0] = patch.fineRight[1] = 0;
+
+			setFineGhostCells(patch, 0);
+			maxTimeStep = std::min(maxTimeStep, m_ratio * patch.solver->computeNumericalFluxes());
+		}
+
+		return maxTimeStep;
+	}
+
+	/**
+	 * Updates the coarse cells, sub-cycles the patches, corrects the
+	 * coarse cells at the interfaces and regrids if necessary.
+	 *
+	 * @param dt coarse time step
+	 */
+	void updateUnknowns(T dt)
+	{
+		m_coarse.updateUnknowns(dt);
+
+		const T fineDt = dt / m_ratio;
+
+		for (unsigned int p = 0; p < m_patches.size(); p++) {
+			Patch &patch = m_patches[p];
+
+			patch.leftNew[0] = m_h[patch.begin-1];
+			patch.leftNew[1] = m_hu[patch.begin-1];
+			patch.rightNew[0] = m_h[patch.end];
+			patch.rightNew[1] = m_hu[patch.end];
+
+			const unsigned int fineSize = patch.solver->getSize();
+
+			for (unsigned int k = 0; k < m_ratio; k++) {
+				if (k > 0) {
+					setFineGhostCells(patch, static_cast<T>(k) / m_ratio);
+					patch.solver->computeNumericalFluxes();
+				}
+
+				// Fine flux through the interfaces in net update form
+				// relative to the coarse neighbour at the beginning of the
+				// coarse time step (see reflux below)
+				unsigned int left = (patch.begin-1) * m_ratio;
+				unsigned int right = (patch.end-1) * m_ratio + 1;
+				T ghostFlux[2], coarseFlux[2];
+
+				T hLeft, hRight, huLeft, huRight;
+				patch.solver->getNetUpdates(0, hLeft, hRight, huLeft, huRight);
+				flux(m_fineH[left], m_fineHu[left], ghostFlux);
+				flux(patch.leftOld[0], patch.leftOld[1], coarseFlux);
+				patch.fineLeft[0] += hLeft + ghostFlux[0] - coarseFlux[0];
+				patch.fineLeft[1] += huLeft + ghostFlux[1] - coarseFlux[1];
+
+				patch.solver->getNetUpdates(fineSize, hLeft, hRight, huLeft, huRight);
+				flux(m_fineH[right], m_fineHu[right], ghostFlux);
+				flux(patch.rightOld[0], patch.rightOld[1], coarseFlux);
+				patch.fineRight[0] += hRight - ghostFlux[0] + coarseFlux[0];
+				patch.fineRight[1] += huRight - ghostFlux[1] + coarseFlux[1];
+
+				patch.solver->updateUnknowns(fineDt);
+			}
+
+			// Refluxing: replace the coarse interface net updates of the
+			// neighbours with the time average of the fine ones. Mass
+			// leaving the coarse cell is exactly the mass entering the patch.
+			// (Ghost cells are not corrected.)
+			if (patch.begin > 1) {
+				m_h[patch.begin-1] += dt/m_cellSize * patch.coarseLeft[0]
+					- fineDt/m_cellSize * patch.fineLeft[0];
+				m_hu[patch.begin-1] += dt/m_cellSize * patch.coarseLeft[1]
+					- fineDt/m_cellSize * patch.fineLeft[1];
+			}
+			if (patch.end < m_size+1) {
+				m_h[patch.end] += dt/m_cellSize * patch.coarseRight[0]
+					- fineDt/m_cellSize * patch.fineRight[0];
+				m_hu[patch.end] += dt/m_cellSize * patch.coarseRight[1]
+					- fineDt/m_cellSize * patch.fineRight[1];
+			}
+
+			restrict(patch);
+		}
+
+		if (++m_stepsSinceRegrid >= m_regridInterval)
+			regrid();
+	}
+
+	/**
+	 * Saves the coarse and the fine unknowns and the refined blocks, e.g.
+	 * to roll back to this state with setState()
+	 *
+	 * @param state output
+	 */
+	void getState(std::vector<T> &state) const
+	{
+		m_coarse.getState(state);
+
+		state.insert(state.end(), m_fineH.begin(), m_fineH.end());
+		state.insert(state.end(), m_fineHu.begin(), m_fineHu.end());
+		for (unsigned int k = 0; k < m_refined.size(); k++)
+			state.push_back(m_refined[k] ? 1 : 0);
+		state.push_back(m_stepsSinceRegrid);
+	}
+
+	/**
+	 * Overwrites the coarse and the fine unknowns and rebuilds the patches
+	 * of the saved state
+	 *
+	 * @param state saved by getState() with the same configuration
+	 */
+	void setState(const std::vector<T> &state)
+	{
+		const unsigned int coarseSize = 2 * (m_size+2);
+		const unsigned int fineSize = m_fineH.size();
+		if (state.size() != coarseSize + 2*fineSize + m_refined.size() + 1)
+			throw std::invalid_argument("The state does not match the size or the refinement");
+
+		std::vector<T>::const_iterator it = state.begin() + coarseSize;
+		m_coarse.setState(std::vector<T>(state.begin(), it));
+
+		std::copy(it, it + fineSize, m_fineH.begin());
+		it += fineSize;
+		std::copy(it, it + fineSize, m_fineHu.begin());
+		it += fineSize;
+		for (unsigned int k = 0; k < m_refined.size(); k++, ++it) {
+			m_refined[k] = *it != 0;
+			if (m_refined[k])
+				injectBathymetry(k);
+		}
+		m_stepsSinceRegrid = static_cast<unsigned int>(*it);
+
+		buildPatches();
+	}
+
+	/**
+	 * @return value itself, there is only one rank (see
+	 *  WavePropagation::reduceMax())
+	 */
+	T reduceMax(T value) const
+	{
+		return value;
+	}
+
+	/**
+	 * Nothing to do (see WavePropagation::synchronize())
+	 */
+	void synchronize()
+	{
+	}
+
+	T getResidual() const
+	{
+		return m_coarse.getResidual();
+	}
+
+	/**
+	 * @return Coarse water heights (averages of the fine cells in refined blocks)
+	 */
+	const T* getHeight() const
+	{
+		return m_h;
+	}
+
+	const T* getMomentum() const
+	{
+		return m_hu;
+	}
+
+	const T* getBathymetry() const
+	{
+		return m_b;
+	}
+
+	unsigned int getSize() const
+	{
+		return m_size;
+	}
+
+	/**
+	 * @return Fine water heights, size * ratio + 2 (only valid in refined blocks)
+	 */
+	const T* getFineHeight() const
+	{
+		return &m_fineH[0];
+	}
+
+	const T* getFineMomentum() const
+	{
+		return &m_fineHu[0];
+	}
+
+	/**
+	 * @return True if the coarse cell pos (incl. ghost cells) is refined
+	 */
+	bool isRefined(unsigned int pos) const
+	{
+		return pos > 0 && pos <= m_size && m_refined[(pos-1) / m_blockSize];
+	}
+
+	/**
+	 * @return Number of cells updated per coarse time step (coarse and fine)
+	 */
+	unsigned int getActiveCells() const
+	{
+		unsigned int cells = m_size;
+		for (unsigned int p = 0; p < m_patches.size(); p++)
+			cells += m_patches[p].solver->getSize();
+		return cells;
+	}
+
+private:
+	/**
+	 * Sets the fine ghost cells of a patch from the coarse neighbours,
+	 * linearly interpolated in time.
+	 *
+	 * @param alpha 0 at the beginning, 1 at the end of the coarse time step
+	 */
+	void setFineGhostCells(Patch &patch, T alpha)
+	{
+		unsigned int left = (patch.begin-1) * m_ratio;
+		unsigned int right = (patch.end-1) * m_ratio + 1;
+
+		m_fineH[left] = (1-alpha) * patch.leftOld[0] + alpha * patch.leftNew[0];
+		m_fineHu[left] = (1-alpha) * patch.leftOld[1] + alpha * patch.leftNew[1];
+		m_fineB[left] = m_b[patch.begin-1];
+		m_fineH[right] = (1-alpha) * patch.rightOld[0] + alpha * patch.rightNew[0];
+		m_fineHu[right] = (1-alpha) * patch.rightOld[1] + alpha * patch.rightNew[1];
+		m_fineB[right] = m_b[patch.end];
+	}
+
+	/**
+	 * Physical flux f = [hu, hu^2/h + 0.5*g*h^2]^T, zero for dry cells
+	 * (where FWave reflects instead)
+	 */
+	static void flux(T h, T hu, T out[2])
+	{
+		if (h < solver::FWave<T>::dryTol) {
+			out[0] = out[1] = 0;
+			return;
+		}
+
+		out[0] = hu;
+		out[1] = hu * hu / h + (T)0.5 * solver::FWave<T>::g * h * h;
+	}
+
+	/**
+	 * Replaces the coarse cells of a patch by the average of the fine cells
+	 */
+	void restrict(const Patch &patch)
+	{
+		for (unsigned int i = patch.begin; i < patch.end; i++) {
+			T h = 0, hu = 0;
+			for (unsigned int j = (i-1) * m_ratio + 1; j <= i * m_ratio; j++) {
+				h += m_fineH[j];
+				hu += m_fineHu[j];
+			}
+			m_h[i] = h / m_ratio;
+			m_hu[i] = hu / m_ratio;
+		}
+	}
+
+	/**
+	 * @return True if the edge between the coarse cells i and i+1 needs refinement
+	 */
+	bool needsRefinement(unsigned int i) const
+	{
+		const T dryTol = solver::FWave<T>::dryTol;
+
+		bool dryLeft = m_h[i] < dryTol;
+		bool dryRight = m_h[i+1] < dryTol;
+		if (dryLeft != dryRight)
+			// Wet/dry front
+			return true;
+		if (dryLeft)
+			return false;
+
+		T h = std::max(m_h[i], m_h[i+1]);
+		T dEta = (m_h[i+1] + m_b[i+1]) - (m_h[i] + m_b[i]);
+		T du = m_hu[i+1] / m_h[i+1] - m_hu[i] / m_h[i];
+
+		return std::fabs(dEta) > m_refineTol * h
+			|| du * du > m_refineTol * m_refineTol * solver::FWave<T>::g * h;
+	}
+
+	/**
+	 * Flags the blocks, initializes new fine blocks from the coarse cells
+	 * and rebuilds the patches
+	 */
+	void regrid()
+	{
+		m_stepsSinceRegrid = 0;
+
+		const unsigned int numBlocks = m_refined.size();
+
+		std::vector<bool> flagged(numBlocks, false);
+		for (unsigned int i = 1; i < m_size; i++) {
+			if (needsRefinement(i)) {
+				flagged[(i-1) / m_blockSize] = true;
+				flagged[i / m_blockSize] = true;
+			}
+		}
+
+		// One buffer block on each side, so fronts do not leave the
+		// refined region before the next regrid
+		std::vector<bool> refined(numBlocks, false);
+		for (unsigned int k = 0; k < numBlocks; k++) {
+			if (flagged[k]) {
+				refined[k] = true;
+				if (k > 0)
+					refined[k-1] = true;
+				if (k+1 < numBlocks)
+					refined[k+1] = true;
+			}
+		}
+
+		// Piecewise constant injection into new fine blocks (conservative)
+		for (unsigned int k = 0; k < numBlocks; k++) {
+			if (!refined[k] || m_refined[k])
+				continue;
+
+			unsigned int end = std::min((k+1) * m_blockSize, m_size);
+			for (unsigned int i = k * m_blockSize + 1; i <= end; i++) {
+				for (unsigned int j = (i-1) * m_ratio + 1; j <= i * m_ratio; j++) {
+					m_fineH[j] = m_h[i];
+					m_fineHu[j] = m_hu[i];
+				}
+			}
+			injectBathymetry(k);
+		}
+
+		m_refined.swap(refined);
+
+		buildPatches();
+	}
+
+	/**
+	 * Initializes the fine bathymetry of a block from the coarse cells
+	 */
+	void injectBathymetry(unsigned int k)
+	{
+		unsigned int end = std::min((k+1) * m_blockSize, m_size);
+		for (unsigned int i = k * m_blockSize + 1; i <= end; i++) {
+			for (unsigned int j = (i-1) * m_ratio + 1; j <= i * m_ratio; j++)
+				m_fineB[j] = m_b[i];
+		}
+	}
+
+	/**
+	 * Creates one patch for each run of refined blocks
+	 */
+	void buildPatches()
+	{
+		const unsigned int numBlocks = m_refined.size();
+
+		clearPatches();
+		for (unsigned int k = 0; k < numBlocks; ) {
+			if (!m_refined[k]) {
+				k++;
+				continue;
+			}
+
+			Patch patch;
+			patch.begin = k * m_blockSize + 1;
+			while (k < numBlocks && m_refined[k])
+				k++;
+			patch.end = std::min(k * m_blockSize, m_size) + 1;
+
+			unsigned int offset = (patch.begin-1) * m_ratio;
+			patch.solver = new WavePropagation(&m_fineH[offset], &m_fineHu[offset], &m_fineB[offset],
+				(patch.end - patch.begin) * m_ratio, m_cellSize / m_ratio);
+			patch.solver->setKernel(m_kernel);
+
+			m_patches.push_back(patch);
+		}
+	}
+
+	void clearPatches()
+	{
+		for (unsigned int p = 0; p < m_patches.size(); p++)
+			delete m_patches[p].solver;
+		m_patches.clear();
+	}
+
+	// Not copyable
+	AdaptiveWavePropagation(const AdaptiveWavePropagation&);
+	AdaptiveWavePropagation& operator=(const AdaptiveWavePropagation&);
+};
+
+#endif /* ADAPTIVEWAVEPROPAGATION_H_ */
@@ -0,0 +1,491 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Chooses the fastest engine configuration (thread count, kernel,
+ *  wet/dry bitmap, y-sweep tile size) with short timed trials on the
+ *  actual scenario.
+ *
+ *  The trials run on copies of the initial values. The parameters are
+ *  tuned one after the other (thread count first, since it changes the
+ *  best values of the others), which needs far fewer trials than a full
+ *  search. The trials of one call take about the time budget (default:
+ *  2 seconds).
+ *
+ *  The result is stored in a per-host profile file, keyed by the
+ *  scenario name, the dimension, the problem size (rounded to a power of
+ *  2), the number of processors and the allowed kernels. Later runs with the same key read
+ *  the configuration from the file and skip the trials.
+ *
+ *  Usage:
+ *  <code>
+ *  Autotuner autotuner;
+ *  Autotuner::Configuration config = autotuner.tune("dambreak", h, hu, b, size, cellSize);
+ *  Autotuner::apply(config, wavePropagation);
+ *  </code>
+ */
+
+#ifndef AUTOTUNER_H_
+#define AUTOTUNER_H_
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "types.h"
+#include "WavePropagation.h"
+#include "WavePropagation2D.h"
+#include "tools/Timer.h"
+
+class Autotuner
+{
+public:
+	struct Configuration
+	{
+		WavePropagation::Kernel kernel;
+		/** Number of OpenMP threads */
+		int numThreads;
+		/** See WavePropagation::setDryBitmap() (1D only) */
+		bool dryBitmap;
+		/** See WavePropagation2D::setTileSize() (2D only) */
+		unsigned int tileWidth;
+		unsigned int tileHeight;
+		/** Measured throughput */
+		double cellsPerSecond;
+
+		Configuration()
+			: kernel(WavePropagation::KernelFWave), numThreads(1), dryBitmap(false),
+			  tileWidth(32), tileHeight(64), cellsPerSecond(0)
+		{
+		}
+	};
+
+private:
+	/** Path of the profile file, empty to disable it */
+	std::string m_profileFile;
+	/** Time of all trials of one tune() call in seconds */
+	double m_budget;
+	/** Also try KernelHybrid (not bitwise identical to KernelFWave) */
+	bool m_allowHybrid;
+
+	/** True if the last configuration was read from the profile file */
+	bool m_fromProfile;
+	/** Number of trials of the last tune() call */
+	unsigned int m_numTrials;
+
+public:
+	/**
+	 * @param profileFile profile file, empty to always run the trials
+	 *  (default: swe1d-<hostname>.profile in the working directory)
+	 * @param budget approximate time of all trials in seconds
+	 */
+	Autotuner(const std::string &profileFile = defaultProfileFile(), double budget = 2)
+		: m_profileFile(profileFile), m_budget(budget), m_allowHybrid(true),
+		  m_fromProfile(false), m_numTrials(0)
+	{
+	}
+
+	/**
+	 * Also consider KernelHybrid (default: true). Disable this if the
+	 * results have to match KernelFWave.
+	 */
+	void setAllowHybrid(bool allowHybrid)
+	{
+		m_allowHybrid = allowHybrid;
+	}
+
+	/**
+	 * @return The fastest configuration for the 1D engine
+	 *
+	 * @param name name of the scenario (part of the profile key)
+	 * @param h initial water heights, size + 2 (not modified)
+	 * @param hu initial momentums, size + 2
+	 * @param b bathymetry, size + 2
+	 */
+	Configuration tune(const std::string &name, const T *h, const T *hu, const T *b,
+			unsigned int size, T cellSize)
+	{
+		std::string key = profileKey("1d", name, size);
+		Configuration config;
+		if (loadProfile(key, config))
+			return config;
+
+		Trial1D trial(h, hu, b, size, cellSize);
+		search(trial, config, false);
+
+		storeProfile(key, config);
+		return config;
+	}
+
+	/**
+	 * @return The fastest configuration for the 2D engine
+	 *
+	 * @param h initial water heights, (nx + 2) * (ny + 2) (not modified)
+	 */
+	Configuration tune(const std::string &name, const T *h, const T *hu, const T *hv, const T *b,
+			unsigned int nx, unsigned int ny, T dx, T dy)
+	{
+		std::string key = profileKey("2d", name, nx * ny);
+		Configuration config;
+		if (loadProfile(key, config))
+			return config;
+
+		Trial2D trial(h, hu, hv, b, nx, ny, dx, dy);
+		search(trial, config, true);
+
+		storeProfile(key, config);
+		return config;
+	}
+
+	/**
+	 * Applies a configuration. The thread count is set for the calling
+	 * thread (omp_set_num_threads()).
+	 */
+	static void apply(const Configuration &config, WavePropagation &wavePropagation)
+	{
+		setNumThreads(config.numThreads);
+		wavePropagation.setKernel(config.kernel);
+		wavePropagation.setDryBitmap(config.dryBitmap);
+	}
+
+	static void apply(const Configuration &config, WavePropagation2D &wavePropagation)
+	{
+		setNumThreads(config.numThreads);
+		wavePropagation.setKernel(config.kernel);
+		wavePropagation.setTileSize(config.tileWidth, config.tileHeight);
+	}
+
+	/**
+	 * @return True if the last configuration was read from the profile file
+	 */
+	bool fromProfile() const
+	{
+		return m_fromProfile;
+	}
+
+	/**
+	 * @return Number of trials of the last call to tune()
+	 */
+	unsigned int getNumTrials() const
+	{
+		return m_numTrials;
+	}
+
+	/**
+	 * @return swe1d-<hostname>.profile
+	 */
+	static std::string defaultProfileFile()
+	{
+		char hostname[256] = "unknown";
+		gethostname(hostname, sizeof(hostname) - 1);
+		return std::string("swe1d-") + hostname + ".profile";
+	}
+
+private:
+	/**
+	 * Runs time steps of the 1D engine on a copy of the initial values
+	 */
+	class Trial1D
+	{
+	private:
+		const T *m_h0, *m_hu0, *m_b0;
+		std::vector<T> m_h, m_hu, m_b;
+		const unsigned int m_size;
+		const T m_cellSize;
+
+	public:
+		Trial1D(const T *h, const T *hu, const T *b, unsigned int size, T cellSize)
+			: m_h0(h), m_hu0(hu), m_b0(b), m_size(size), m_cellSize(cellSize)
+		{
+		}
+
+		unsigned int numCells() const
+		{
+			return m_size;
+		}
+
+		/**
+		 * @return Time steps per second
+		 */
+		double run(const Configuration &config, double seconds)
+		{
+			m_h.assign(m_h0, m_h0 + m_size+2);
+			m_hu.assign(m_hu0, m_hu0 + m_size+2);
+			m_b.assign(m_b0, m_b0 + m_size+2);
+
+			WavePropagation wavePropagation(&m_h[0], &m_hu[0], &m_b[0], m_size, m_cellSize);
+			apply(config, wavePropagation);
+			return timeSteps(wavePropagation, seconds);
+		}
+	};
+
+	/**
+	 * Runs time steps of the 2D engine on a copy of the initial values
+	 */
+	class Trial2D
+	{
+	private:
+		const T *m_h0, *m_hu0, *m_hv0, *m_b0;
+		std::vector<T> m_h, m_hu, m_hv, m_b;
+		const unsigned int m_nx, m_ny;
+		const T m_dx, m_dy;
+
+	public:
+		Trial2D(const T *h, const T *hu, const T *hv, const T *b,
+				unsigned int nx, unsigned int ny, T dx, T dy)
+			: m_h0(h), m_hu0(hu), m_hv0(hv), m_b0(b), m_nx(nx), m_ny(ny), m_dx(dx), m_dy(dy)
+		{
+		}
+
+		unsigned int numCells() const
+		{
+			return m_nx * m_ny;
+		}
+
+		double run(const Configuration &config, double seconds)
+		{
+			const unsigned int n = (m_nx+2) * (m_ny+2);
+			m_h.assign(m_h0, m_h0 + n);
+			m_hu.assign(m_hu0, m_hu0 + n);
+			m_hv.assign(m_hv0, m_hv0 + n);
+			m_b.assign(m_b0, m_b0 + n);
+
+			WavePropagation2D wavePropagation(&m_h[0], &m_hu[0], &m_hv[0], &m_b[0],
+				m_nx, m_ny, m_dx, m_dy);
+			apply(config, wavePropagation);
+			return timeSteps(wavePropagation, seconds);
+		}
+	};
+
+	/**
+	 * Tunes one parameter after the other
+	 *
+	 * @param config output, the fastest configuration
+	 */
+	template<class Trial>
+	void search(Trial &trial, Configuration &config, bool tiles)
+	{
+		std::vector<Configuration> candidates;
+
+		// Thread counts: powers of 2 and all processors
+		const int maxThreads = numProcessors();
+		for (int t = 1; t < maxThreads; t *= 2) {
+			candidates.push_back(config);
+			candidates.back().numThreads = t;
+		}
+		candidates.push_back(config);
+		candidates.back().numThreads = maxThreads;
+
+		std::vector<Configuration> kernels;
+		kernels.push_back(config);
+		if (m_allowHybrid) {
+			kernels.push_back(config);
+			kernels.back().kernel = WavePropagation::KernelHybrid;
+		}
+
+		std::vector<Configuration> variants;
+		if (tiles) {
+			const unsigned int widths[] = { 8, 16, 32, 64 };
+			const unsigned int heights[] = { 32, 64, 128 };
+			for (unsigned int i = 0; i < sizeof(widths)/sizeof(widths[0]); i++) {
+				for (unsigned int j = 0; j < sizeof(heights)/sizeof(heights[0]); j++) {
+					variants.push_back(config);
+					variants.back().tileWidth = widths[i];
+					variants.back().tileHeight = heights[j];
+				}
+			}
+		} else {
+			variants.push_back(config);
+			variants.push_back(config);
+			variants.back().dryBitmap = true;
+		}
+
+		m_numTrials = 0;
+		const double trialSeconds = m_budget
+			/ (candidates.size() + kernels.size() + variants.size());
+		// Restore the thread count of the caller afterwards
+		const int oldNumThreads = maxThreadsOfCaller();
+
+		config = fastest(trial, candidates, trialSeconds);
+		for (unsigned int i = 0; i < kernels.size(); i++)
+			kernels[i].numThreads = config.numThreads;
+		config = fastest(trial, kernels, trialSeconds);
+
+		for (unsigned int i = 0; i < variants.size(); i++) {
+			variants[i].numThreads = config.numThreads;
+			variants[i].kernel = config.kernel;
+		}
+		config = fastest(trial, variants, trialSeconds);
+
+		setNumThreads(oldNumThreads);
+	}
+
+	/**
+	 * @return The fastest of the candidates
+	 */
+	template<class Trial>
+	Configuration fastest(Trial &trial, std::vector<Configuration> &candidates, double seconds)
+	{
+		unsigned int best = 0;
+		for (unsigned int i = 0; i < candidates.size(); i++) {
+			candidates[i].cellsPerSecond = trial.run(candidates[i], seconds) * trial.numCells();
+			m_numTrials++;
+
+			if (candidates[i].cellsPerSecond > candidates[best].cellsPerSecond)
+				best = i;
+		}
+
+		return candidates[best];
+	}
+
+	/**
+	 * Runs time steps for about the given time. The first step (page
+	 * faults, thread startup) is not measured.
+	 *
+	 * @return Time steps per second
+	 */
+	template<class Engine>
+	static double timeSteps(Engine &wavePropagation, double seconds)
+	{
+		wavePropagation.setOutflowBoundaryConditions();
+		wavePropagation.updateUnknowns(wavePropagation.computeNumericalFluxes());
+
+		unsigned int steps = 0;
+		double elapsed;
+		double start = tools::Timer::now();
+		do {
+			wavePropagation.setOutflowBoundaryConditions();
+			T dt = wavePropagation.computeNumericalFluxes();
+			wavePropagation.updateUnknowns(dt);
+
+			steps++;
+			elapsed = tools::Timer::now() - start;
+		} while (elapsed < seconds);
+
+		return steps / elapsed;
+	}
+
+	std::string profileKey(const char* dimension, const std::string &name, unsigned int numCells) const
+	{
+		unsigned int log2Cells = 0;
+		while ((2u << log2Cells) <= numCells)
+			log2Cells++;
+
+		std::ostringstream key;
+		key << dimension << ' ' << name << ' ' << log2Cells << ' ' << numProcessors()
+			<< ' ' << (m_allowHybrid ? "fwave,hybrid" : "fwave");
+		return key.str();
+	}
+
+	/**
+	 * Profile file: one line per key,
+	 * <code>dimension name log2(cells) processors allowedKernels kernel threads dryBitmap tileWidth tileHeight cellsPerSecond</code>
+	 *
+	 * @return True if the key was found
+	 */
+	bool loadProfile(const std::string &key, Configuration &config)
+	{
+		m_fromProfile = false;
+		m_numTrials = 0;
+		if (m_profileFile.empty())
+			return false;
+
+		std::ifstream in(m_profileFile.c_str());
+		std::string line;
+		while (std::getline(in, line)) {
+			if (line.compare(0, key.size() + 1, key + ' ') != 0)
+				continue;
+
+			std::istringstream values(line.substr(key.size() + 1));
+			std::string kernel;
+			values >> kernel >> config.numThreads >> config.dryBitmap
+				>> config.tileWidth >> config.tileHeight >> config.cellsPerSecond;
+			if (!values || config.numThreads < 1)
+				continue;
+
+			config.kernel = (kernel == "hybrid" ? WavePropagation::KernelHybrid : WavePropagation::KernelFWave);
+			// Edited by hand
+			if (config.kernel == WavePropagation::KernelHybrid && !m_allowHybrid)
+				continue;
+
+			m_fromProfile = true;
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Adds (or replaces) the key in the profile file. Other keys are kept.
+	 * The file is replaced atomically, so concurrent runs do not see a
+	 * partial file (but one of them may lose its entry).
+	 */
+	void storeProfile(const std::string &key, const Configuration &config) const
+	{
+		if (m_profileFile.empty())
+			return;
+
+		std::vector<std::string> lines;
+		{
+			std::ifstream in(m_profileFile.c_str());
+			std::string line;
+			while (std::getline(in, line)) {
+				if (line.compare(0, key.size() + 1, key + ' ') != 0)
+					lines.push_back(line);
+			}
+		}
+
+		std::ostringstream entry;
+		entry << key << ' ' << (config.kernel == WavePropagation::KernelHybrid ? "hybrid" : "fwave")
+			<< ' ' << config.numThreads << ' ' << config.dryBitmap
+			<< ' ' << config.tileWidth << ' ' << config.tileHeight
+			<< ' ' << config.cellsPerSecond;
+		lines.push_back(entry.str());
+
+		std::string tmpFile = m_profileFile + ".tmp";
+		{
+			std::ofstream out(tmpFile.c_str());
+			for (unsigned int i = 0; i < lines.size(); i++)
+				out << lines[i] << '\n';
+			if (!out)
+				return;
+		}
+		std::rename(tmpFile.c_str(), m_profileFile.c_str());
+	}
+
+	static int numProcessors()
+	{
+#ifdef _OPENMP
+		return omp_get_num_procs();
+#else
+		return 1;
+#endif
+	}
+
+	static int maxThreadsOfCaller()
+	{
+#ifdef _OPENMP
+		return omp_get_max_threads();
+#else
+		return 1;
+#endif
+	}
+
+	static void setNumThreads(int numThreads)
+	{
+#ifdef _OPENMP
+		omp_set_num_threads(numThreads);
+#endif
+	}
+};
+
+#endif /* AUTOTUNER_H_ */
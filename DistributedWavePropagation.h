@@ -0,0 +1,488 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Wave propagation on a domain split into contiguous slabs, one for each
+ *  process (rank). The ghost cells between the slabs are exchanged with
+ *  a tools::Transport.
+ */
+
+#ifndef DISTRIBUTEDWAVEPROPAGATION_H_
+#define DISTRIBUTEDWAVEPROPAGATION_H_
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "types.h"
+#include "WavePropagation.h"
+#include "tools/Instrumentation.h"
+#include "tools/Tracer.h"
+#include "tools/Transport.h"
+
+/**
+ * Same interface as WavePropagation, but all methods except the getters
+ * are collective: all ranks have to call them in the same order.
+ *
+ * The halo exchange overlaps with the net updates on the interior edges.
+ * Only the two edges next to the ghost cells have to wait for the
+ * neighbours.
+ *
+ * With setDeferredCfl(), the global CFL reduction (one synchronization
+ * of all ranks) is only done every few time steps. In between, the time
+ * step of the last reduction is reused, reduced by a safety factor for
+ * the growth of the wave speeds. Each rank checks every reused time step
+ * against the wave speed it was computed for. The state of the last
+ * reduction is kept; if any rank found a violation, the next reduction
+ * (or synchronize()) restores it and redoes the time steps up to the
+ * current time with exact reductions.
+ */
+class DistributedWavePropagation
+{
+private:
+	tools::Transport &m_transport;
+
+	/** Engine on the local slab */
+	WavePropagation m_local;
+
+	T *m_h;
+	T *m_hu;
+	T *m_b;
+
+	/** Number of local cells */
+	const unsigned int m_size;
+	const T m_cellSize;
+
+	/** Total number of cells of all ranks, 0 if not yet known */
+	T m_globalSize;
+
+	/** Time steps between two CFL reductions (1: every time step) */
+	unsigned int m_cflInterval;
+	/** Assumed growth of the max wave speed until the next reduction */
+	T m_cflGrowth;
+	/** Time steps since the last reduction */
+	unsigned int m_stepsSinceReduction;
+	/** Time step reused until the next reduction, 0 before the first one */
+	T m_deferredTimeStep;
+	/** Largest wave speed allowed with the reused time step */
+	T m_waveSpeedBound;
+	/** True if a reused time step exceeded the bound on this rank */
+	bool m_violated;
+
+	/** Simulated time, set by setBoundaryConditions() and updateUnknowns() */
+	T m_time;
+	/** True if the boundaries are set by setBoundaryConditions() */
+	bool m_timedBoundaries;
+	/** Local state and time of the last reduction (deferred reductions only) */
+	std::vector<T> m_reducedState;
+	T m_reducedTime;
+
+	unsigned long m_numReductions;
+	unsigned long m_numFallbacks;
+
+public:
+	/**
+	 * @param transport connection to the other ranks
+	 * @param h water heights of the local slab, size + 2 (incl. ghost cells)
+	 * @param hu momentums of the local slab, size + 2
+	 * @param b bathymetry of the local slab, size + 2
+	 * @param size number of local cells (at least 1), see partition()
+	 * @param cellSize size of one cell
+	 */
+	DistributedWavePropagation(tools::Transport &transport,
+			T *h, T *hu, T *b, unsigned int size, T cellSize)
+		: m_transport(transport),
+		  m_local(h, hu, b, size, cellSize),
+		  m_h(h), m_hu(hu), m_b(b),
+		  m_size(size), m_cellSize(cellSize),
+		  m_globalSize(0),
+		  m_cflInterval(1), m_cflGrowth(1),
+		  m_stepsSinceReduction(0),
+		  m_deferredTimeStep(0), m_waveSpeedBound(0), m_violated(false),
+		  m_time(0), m_timedBoundaries(false), m_reducedTime(0),
+		  m_numReductions(0), m_numFallbacks(0)
+	{
+	}
+
+	/**
+	 * Computes the slab of a rank. The cells are distributed as evenly as
+	 * possible.
+	 *
+	 * @param size total number of cells
+	 * @param offset output, global index of the first cell of the slab
+	 * @param localSize output, number of cells in the slab
+	 */
+	static void partition(unsigned int size, unsigned int rank, unsigned int numRanks,
+			unsigned int &offset, unsigned int &localSize)
+	{
+		localSize = size / numRanks;
+		unsigned int rest = size % numRanks;
+
+		if (rank < rest) {
+			localSize++;
+			offset = rank * localSize;
+		} else {
+			offset = rank * localSize + rest;
+		}
+	}
+
+	void setKernel(WavePropagation::Kernel kernel)
+	{
+		m_local.setKernel(kernel);
+	}
+
+	/**
+	 * See WavePropagation::setCflNumber(). Has to be the same on all ranks.
+	 */
+	void setCflNumber(T cflNumber)
+	{
+		m_local.setCflNumber(cflNumber);
+	}
+
+	T getCflNumber() const
+	{
+		return m_local.getCflNumber();
+	}
+
+	/**
+	 * Reduces the global max wave speed only every interval time steps.
+	 * Has to be the same on all ranks.
+	 *
+	 * Between two reductions, the time step is computed from the last
+	 * global max wave speed times growth. Each reused time step is checked
+	 * against this wave speed. If a wave speed grew by more than the
+	 * factor, the time steps since the last reduction are redone with
+	 * exact reductions, so the result satisfies the CFL condition in any
+	 * case. A larger growth (e.g. for wetting and drying) costs a smaller
+	 * time step, a violated bound costs the redone time steps.
+	 *
+	 * Keeps a copy of the local state. The time steps are redone with the
+	 * CFL time step, a smaller factor applied by the caller (e.g. after a
+	 * rollback of the health check) is not repeated.
+	 *
+	 * @param interval time steps between two reductions, 1 disables the
+	 *  deferred reduction
+	 * @param growth assumed growth of the max wave speed, at least 1
+	 */
+	void setDeferredCfl(unsigned int interval, T growth = 1.25)
+	{
+		if (interval < 1 || !(growth >= 1))
+			throw std::invalid_argument("Deferred CFL needs an interval >= 1 and a growth >= 1");
+
+		m_cflInterval = interval;
+		m_cflGrowth = growth;
+		resetDeferredCfl();
+	}
+
+	/**
+	 * Computes the net updates on all edges of the slab.
+	 *
+	 * @return Global maximum allowed time step (CFL condition)
+	 */
+	T computeNumericalFluxes()
+	{
+		T maxWaveSpeed = computeNetUpdates();
+
+		if (m_cflInterval > 1)
+			return deferredTimeStep(maxWaveSpeed);
+
+		return m_cellSize / reduceWaveSpeed(maxWaveSpeed) * m_local.getCflNumber();
+	}
+
+	void updateUnknowns(T dt)
+	{
+		m_local.updateUnknowns(dt);
+		m_time += dt;
+	}
+
+	/**
+	 * Checks the time steps since the last deferred CFL reduction and
+	 * redoes them if necessary (see setDeferredCfl()). The next time step
+	 * starts with a reduction. Has to be called before the state is used,
+	 * e.g. written (the Simulator does this).
+	 */
+	void synchronize()
+	{
+		if (m_cflInterval == 1 || m_stepsSinceReduction == 0)
+			return;
+
+		T violated;
+		{
+			INSTR_PHASE(Reduction);
+			TRACE_SCOPE("cfl_reduction");
+			violated = m_transport.allReduceMax(m_violated ? 1 : 0);
+		}
+		m_numReductions++;
+
+		if (violated > 0)
+			redo();
+
+		resetDeferredCfl();
+	}
+
+	/**
+	 * Sets outflow boundary conditions at the ends of the global domain.
+	 * The ghost cells between two ranks are set by computeNumericalFluxes().
+	 */
+	void setOutflowBoundaryConditions()
+	{
+		INSTR_PHASE(Boundary);
+		TRACE_SCOPE("boundary");
+
+		m_timedBoundaries = false;
+
+		if (m_transport.rank() == 0) {
+			m_h[0] = m_h[1];
+			m_hu[0] = m_hu[1];
+			m_b[0] = m_b[1];
+		}
+		if (m_transport.rank() == m_transport.numRanks()-1) {
+			m_h[m_size+1] = m_h[m_size];
+			m_hu[m_size+1] = m_hu[m_size];
+			m_b[m_size+1] = m_b[m_size];
+		}
+	}
+
+	/**
+	 * Set the boundary condition of one end of the global domain (default:
+	 * outflow). Has to be the same on all ranks.
+	 */
+	void setBoundary(tools::Boundary::Side side, const tools::Boundary &boundary)
+	{
+		m_local.setBoundary(side, boundary);
+	}
+
+	/**
+	 * Sets the boundary conditions at the ends of the global domain. The
+	 * ghost cells between two ranks are set by computeNumericalFluxes().
+	 */
+	void setBoundaryConditions(T time)
+	{
+		m_time = time;
+		m_timedBoundaries = true;
+
+		// The inner ghost cells are overwritten by the halo exchange
+		m_local.setBoundaryConditions(time);
+	}
+
+	/**
+	 * See WavePropagation::getState(), the state of the local slab
+	 */
+	void getState(std::vector<T> &state) const
+	{
+		m_local.getState(state);
+	}
+
+	/**
+	 * Overwrites the unknowns of the local slab. Not collective, but all
+	 * ranks have to restore the same time step.
+	 *
+	 * @param state saved by getState() on this rank
+	 */
+	void setState(const std::vector<T> &state)
+	{
+		m_local.setState(state);
+		resetDeferredCfl();
+	}
+
+	/**
+	 * Collective decisions, e.g. of the health check in the Simulator
+	 *
+	 * @return Maximum of value on all ranks
+	 */
+	T reduceMax(T value)
+	{
+		INSTR_PHASE(Reduction);
+		TRACE_SCOPE("max_reduction");
+
+		return m_transport.allReduceMax(value);
+	}
+
+	/**
+	 * @return Global residual (see WavePropagation::getResidual())
+	 */
+	T getResidual()
+	{
+		INSTR_PHASE(Reduction);
+		TRACE_SCOPE("residual_reduction");
+
+		if (m_globalSize == 0)
+			m_globalSize = m_transport.allReduceSum(m_size);
+
+		return m_transport.allReduceSum(m_local.getResidual() * m_size) / m_globalSize;
+	}
+
+	/**
+	 * @return Number of global CFL reductions
+	 */
+	unsigned long getNumReductions() const
+	{
+		return m_numReductions;
+	}
+
+	/**
+	 * @return Number of violated wave speed bounds, each redoes the time
+	 *  steps since the last reduction (see setDeferredCfl())
+	 */
+	unsigned long getNumFallbacks() const
+	{
+		return m_numFallbacks;
+	}
+
+	/**
+	 * @return Water heights of the local slab, size + 2 (incl. ghost cells)
+	 */
+	const T* getHeight() const
+	{
+		return m_h;
+	}
+
+	/**
+	 * @return Momentums of the local slab, size + 2 (incl. ghost cells)
+	 */
+	const T* getMomentum() const
+	{
+		return m_hu;
+	}
+
+	/**
+	 * @return Bathymetry of the local slab, size + 2 (incl. ghost cells)
+	 */
+	const T* getBathymetry() const
+	{
+		return m_b;
+	}
+
+	/**
+	 * @return Number of local cells (without ghost cells)
+	 */
+	unsigned int getSize() const
+	{
+		return m_size;
+	}
+
+private:
+	/**
+	 * Exchanges the halos and computes the net updates on all edges
+	 *
+	 * @return Local max wave speed
+	 */
+	T computeNetUpdates()
+	{
+		T left[tools::Transport::HaloSize] = { m_h[1], m_hu[1], m_b[1] };
+		T right[tools::Transport::HaloSize] = { m_h[m_size], m_hu[m_size], m_b[m_size] };
+		m_transport.sendHalos(left, right);
+
+		// Edges between two local cells
+		T maxWaveSpeed = m_local.computeNetUpdates(1, m_size);
+
+		{
+			TRACE_SCOPE("halo_wait");
+
+			// Physical boundaries keep the values set by
+			// setOutflowBoundaryConditions() or setBoundaryConditions()
+			left[0] = m_h[0]; left[1] = m_hu[0]; left[2] = m_b[0];
+			right[0] = m_h[m_size+1]; right[1] = m_hu[m_size+1]; right[2] = m_b[m_size+1];
+			m_transport.receiveHalos(left, right);
+			m_h[0] = left[0]; m_hu[0] = left[1]; m_b[0] = left[2];
+			m_h[m_size+1] = right[0]; m_hu[m_size+1] = right[1]; m_b[m_size+1] = right[2];
+		}
+
+		maxWaveSpeed = std::max(maxWaveSpeed, m_local.computeNetUpdates(0, 1));
+		maxWaveSpeed = std::max(maxWaveSpeed, m_local.computeNetUpdates(m_size, m_size+1));
+
+		return maxWaveSpeed;
+	}
+
+	/**
+	 * @return Global max wave speed
+	 */
+	T reduceWaveSpeed(T maxWaveSpeed)
+	{
+		INSTR_PHASE(Reduction);
+		TRACE_SCOPE("cfl_reduction");
+
+		m_numReductions++;
+		return m_transport.allReduceMax(maxWaveSpeed);
+	}
+
+	/**
+	 * The next time step starts with a reduction
+	 */
+	void resetDeferredCfl()
+	{
+		m_stepsSinceReduction = 0;
+		m_deferredTimeStep = 0;
+		m_violated = false;
+	}
+
+	/**
+	 * Time step with deferred CFL reduction
+	 *
+	 * @param maxWaveSpeed local max wave speed of this time step
+	 */
+	T deferredTimeStep(T maxWaveSpeed)
+	{
+		if (m_deferredTimeStep > 0 && ++m_stepsSinceReduction < m_cflInterval) {
+			// Reuse the time step, checked by the next reduction
+			if (maxWaveSpeed > m_waveSpeedBound)
+				m_violated = true;
+			return m_deferredTimeStep;
+		}
+
+		// Infinity marks a violated bound on any rank, so the decision is
+		// the same on all ranks
+		T reduced = reduceWaveSpeed(m_violated ? std::numeric_limits<T>::infinity() : maxWaveSpeed);
+		if (reduced == std::numeric_limits<T>::infinity()) {
+			redo();
+
+			// This time step again, from the redone state
+			applyBoundaryConditions(m_time);
+			reduced = reduceWaveSpeed(computeNetUpdates());
+		}
+
+		m_local.getState(m_reducedState);
+		m_reducedTime = m_time;
+		m_stepsSinceReduction = 0;
+		m_violated = false;
+		m_waveSpeedBound = reduced * m_cflGrowth;
+		m_deferredTimeStep = m_cellSize / m_waveSpeedBound * m_local.getCflNumber();
+
+		return m_cellSize / reduced * m_local.getCflNumber();
+	}
+
+	/**
+	 * Restores the state of the last reduction and redoes the time steps
+	 * up to the current time with exact reductions
+	 */
+	void redo()
+	{
+		TRACE_SCOPE("cfl_redo");
+
+		m_numFallbacks++;
+
+		const T endTime = m_time;
+		m_local.setState(m_reducedState);
+		m_time = m_reducedTime;
+
+		while (m_time < endTime) {
+			applyBoundaryConditions(m_time);
+			T dt = m_cellSize / reduceWaveSpeed(computeNetUpdates()) * m_local.getCflNumber();
+			updateUnknowns(std::min(dt, endTime - m_time));
+		}
+	}
+
+	/**
+	 * Sets the boundary conditions the same way as the caller
+	 */
+	void applyBoundaryConditions(T time)
+	{
+		if (m_timedBoundaries)
+			setBoundaryConditions(time);
+		else
+			setOutflowBoundaryConditions();
+	}
+};
+
+#endif /* DISTRIBUTEDWAVEPROPAGATION_H_ */
@@ -0,0 +1,341 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Parallel-in-time integration with Parareal.
+ *
+ *  The time interval is split into slices. A cheap coarse propagator G
+ *  (WavePropagation on a grid coarsened by an integer factor and/or with
+ *  a larger CFL number) runs serially over all slices. The accurate fine
+ *  propagator F (WavePropagation on the full grid) runs on all slices at
+ *  the same time. Each iteration corrects the slice start values with
+ *
+ *  U[n+1] = G(U_new[n]) + F(U_old[n]) - G(U_old[n])
+ *
+ *  After k iterations the first k slices are exact, so at most one
+ *  iteration per slice is needed. The speedup depends on the number of
+ *  iterations until the defect is below the tolerance.
+ */
+
+#ifndef PARAREAL_H_
+#define PARAREAL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <vector>
+
+#include "types.h"
+#include "WavePropagation.h"
+#include "tools/Boundary.h"
+#include "tools/Timer.h"
+#include "tools/Tracer.h"
+
+class Parareal
+{
+private:
+	/** Number of fine cells */
+	const unsigned int m_size;
+	const T m_cellSize;
+	const unsigned int m_numSlices;
+
+	/** Fine cells per coarse cell */
+	const unsigned int m_coarsening;
+	/** Number of coarse cells */
+	const unsigned int m_coarseSize;
+	/** CFL number of the coarse propagator */
+	T m_coarseCflNumber;
+
+	/** Maximum relative change of the slice values at convergence */
+	T m_tolerance;
+	unsigned int m_maxIterations;
+
+	WavePropagation::Kernel m_kernel;
+
+	/** Boundary conditions of both propagators */
+	tools::Boundary m_boundaries[2];
+
+	/** Defect of each iteration */
+	std::vector<T> m_defects;
+	bool m_converged;
+
+	/** Time spent in the fine and coarse propagators of the last run */
+	double m_fineSeconds;
+	double m_coarseSeconds;
+
+public:
+	/**
+	 * @param size number of cells
+	 * @param cellSize size of one cell
+	 * @param numSlices number of time slices (usually the number of cores)
+	 * @param coarsening fine cells per coarse cell of the coarse propagator
+	 * @param coarseCflNumber CFL number of the coarse propagator (at most 1)
+	 */
+	Parareal(unsigned int size, T cellSize, unsigned int numSlices,
+			unsigned int coarsening = 4, T coarseCflNumber = 0.9)
+		: m_size(size), m_cellSize(cellSize), m_numSlices(numSlices),
+		  m_coarsening(coarsening), m_coarseSize((size + coarsening - 1) / coarsening),
+		  m_coarseCflNumber(coarseCflNumber),
+		  m_tolerance(1e-4), m_maxIterations(numSlices),
+		  m_kernel(WavePropagation::KernelFWave),
+		  m_converged(false), m_fineSeconds(0), m_coarseSeconds(0)
+	{
+	}
+
+	/**
+	 * @param tolerance stop once the largest relative L1 change of a slice
+	 *  value is below the tolerance (default: 1e-4)
+	 * @param maxIterations maximum number of iterations (default: number of
+	 *  slices, which gives the fine solution)
+	 */
+	void setConvergence(T tolerance, unsigned int maxIterations)
+	{
+		m_tolerance = tolerance;
+		m_maxIterations = std::min(maxIterations, m_numSlices);
+	}
+
+	/**
+	 * Select the solver of both propagators (default: KernelFWave)
+	 */
+	void setKernel(WavePropagation::Kernel kernel)
+	{
+		m_kernel = kernel;
+	}
+
+	/**
+	 * Set the boundary condition of one end for both propagators
+	 * (default: outflow), see WavePropagation::setBoundary()
+	 */
+	void setBoundary(tools::Boundary::Side side, const tools::Boundary &boundary)
+	{
+		m_boundaries[side] = boundary;
+	}
+
+	/**
+	 * Integrates from time 0 to endTime.
+	 *
+	 * @param h water heights, size + 2 (incl. ghost cells), overwritten
+	 *  with the values at endTime
+	 * @param hu momentums, size + 2, overwritten with the values at endTime
+	 * @param b bathymetry, size + 2
+	 * @return Number of iterations
+	 */
+	unsigned int run(T *h, T *hu, const T *b, T endTime)
+	{
+		const unsigned int n = m_size + 2;
+		const T sliceTime = endTime / m_numSlices;
+
+		m_defects.clear();
+		m_converged = false;
+		m_fineSeconds = m_coarseSeconds = 0;
+
+		std::vector<T> bCoarse(m_coarseSize + 2);
+		restrictCells(b, &bCoarse[0]);
+
+		// Start values of the slices (and the end value)
+		std::vector<T> uH((m_numSlices+1) * n), uHu((m_numSlices+1) * n);
+		// Coarse and fine results of the slices
+		std::vector<T> gH(m_numSlices * n), gHu(m_numSlices * n);
+		std::vector<T> fH(m_numSlices * n), fHu(m_numSlices * n);
+		// Each slice needs its own bathymetry (the ghost cells are written)
+		std::vector<T> fB(m_numSlices * n);
+
+		std::copy(h, h + n, uH.begin());
+		std::copy(hu, hu + n, uHu.begin());
+		for (unsigned int s = 0; s < m_numSlices; s++)
+			std::copy(b, b + n, fB.begin() + s*n);
+
+		// Initial guess
+		double start = tools::Timer::now();
+		for (unsigned int s = 0; s < m_numSlices; s++) {
+			coarse(&uH[s*n], &uHu[s*n], &bCoarse[0], s*sliceTime, sliceTime, &gH[s*n], &gHu[s*n]);
+			std::copy(gH.begin() + s*n, gH.begin() + (s+1)*n, uH.begin() + (s+1)*n);
+			std::copy(gHu.begin() + s*n, gHu.begin() + (s+1)*n, uHu.begin() + (s+1)*n);
+		}
+		m_coarseSeconds += tools::Timer::now() - start;
+
+		std::vector<T> newH(n), newHu(n);
+
+		unsigned int k;
+		for (k = 0; k < m_maxIterations && !m_converged; k++) {
+			start = tools::Timer::now();
+
+			// Slices before k are already exact
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(dynamic, 1)
+#endif
+			for (unsigned int s = k; s < m_numSlices; s++) {
+				TRACE_SCOPE("fine_slice");
+
+				std::copy(uH.begin() + s*n, uH.begin() + (s+1)*n, fH.begin() + s*n);
+				std::copy(uHu.begin() + s*n, uHu.begin() + (s+1)*n, fHu.begin() + s*n);
+				fine(&fH[s*n], &fHu[s*n], &fB[s*n], s*sliceTime, sliceTime);
+			}
+
+			m_fineSeconds += tools::Timer::now() - start;
+			start = tools::Timer::now();
+
+			T defect = 0;
+			for (unsigned int s = k; s < m_numSlices; s++) {
+				coarse(&uH[s*n], &uHu[s*n], &bCoarse[0], s*sliceTime, sliceTime, &newH[0], &newHu[0]);
+
+				T diff = 0, norm = 0;
+				for (unsigned int i = 1; i < m_size+1; i++) {
+					T uNewH = newH[i] + fH[s*n+i] - gH[s*n+i];
+					T uNewHu = newHu[i] + fHu[s*n+i] - gHu[s*n+i];
+					// The correction must not create negative heights
+					if (uNewH < 0)
+						uNewH = uNewHu = 0;
+
+					T &uOldH = uH[(s+1)*n+i];
+					T &uOldHu = uHu[(s+1)*n+i];
+					diff += std::fabs(uNewH - uOldH) + std::fabs(uNewHu - uOldHu);
+					norm += std::fabs(uNewH) + std::fabs(uNewHu);
+					uOldH = uNewH;
+					uOldHu = uNewHu;
+				}
+				// A dry slice has no relative change, only an absolute one
+				defect = std::max(defect, norm > 0 ? diff / norm : diff);
+
+				std::copy(newH.begin(), newH.end(), gH.begin() + s*n);
+				std::copy(newHu.begin(), newHu.end(), gHu.begin() + s*n);
+			}
+
+			m_coarseSeconds += tools::Timer::now() - start;
+
+			m_defects.push_back(defect);
+			m_converged = defect < m_tolerance;
+		}
+
+		std::copy(uH.begin() + m_numSlices*n, uH.end(), h);
+		std::copy(uHu.begin() + m_numSlices*n, uHu.end(), hu);
+
+		return k;
+	}
+
+	/**
+	 * @return True if the last run stopped because the defect was below
+	 *  the tolerance
+	 */
+	bool converged() const
+	{
+		return m_converged;
+	}
+
+	/**
+	 * @return The maximum relative change of the slice values in each
+	 *  iteration of the last run
+	 */
+	const std::vector<T>& getDefects() const
+	{
+		return m_defects;
+	}
+
+	/**
+	 * @return Wall clock time of the fine propagators in the last run
+	 */
+	double getFineSeconds() const
+	{
+		return m_fineSeconds;
+	}
+
+	/**
+	 * @return Wall clock time of the (serial) coarse propagators in the last run
+	 */
+	double getCoarseSeconds() const
+	{
+		return m_coarseSeconds;
+	}
+
+	/**
+	 * Writes the convergence report of the last run as JSON
+	 */
+	void writeReport(std::ostream &out) const
+	{
+		out << "{\"slices\": " << m_numSlices
+			<< ", \"iterations\": " << m_defects.size()
+			<< ", \"converged\": " << (m_converged ? "true" : "false")
+			<< ", \"defects\": [";
+		for (unsigned int i = 0; i < m_defects.size(); i++)
+			out << (i == 0 ? "" : ", ") << m_defects[i];
+		out << "], \"fine_seconds\": " << m_fineSeconds
+			<< ", \"coarse_seconds\": " << m_coarseSeconds << '}';
+	}
+
+private:
+	/**
+	 * Runs the fine propagator in place
+	 *
+	 * @param startTime simulated time at the beginning of the slice
+	 */
+	void fine(T *h, T *hu, T *b, T startTime, T duration) const
+	{
+		WavePropagation wavePropagation(h, hu, b, m_size, m_cellSize);
+		wavePropagation.setKernel(m_kernel);
+		propagate(wavePropagation, startTime, duration);
+	}
+
+	/**
+	 * Runs the coarse propagator
+	 *
+	 * @param h fine start values, size + 2
+	 * @param bCoarse coarse bathymetry
+	 * @param outH fine end values, size + 2
+	 */
+	void coarse(const T *h, const T *hu, const T *bCoarse, T startTime, T duration, T *outH, T *outHu) const
+	{
+		std::vector<T> hCoarse(m_coarseSize+2), huCoarse(m_coarseSize+2), b(bCoarse, bCoarse + m_coarseSize+2);
+		restrictCells(h, &hCoarse[0]);
+		restrictCells(hu, &huCoarse[0]);
+
+		WavePropagation wavePropagation(&hCoarse[0], &huCoarse[0], &b[0], m_coarseSize,
+			m_cellSize * m_coarsening);
+		wavePropagation.setKernel(m_kernel);
+		wavePropagation.setCflNumber(m_coarseCflNumber);
+		propagate(wavePropagation, startTime, duration);
+
+		// Piecewise constant prolongation
+		for (unsigned int i = 0; i < m_size; i++) {
+			outH[i+1] = hCoarse[i / m_coarsening + 1];
+			outHu[i+1] = huCoarse[i / m_coarsening + 1];
+		}
+		outH[0] = outHu[0] = outH[m_size+1] = outHu[m_size+1] = 0;
+	}
+
+	/**
+	 * Averages the fine cells of each coarse cell
+	 */
+	void restrictCells(const T *values, T *coarseValues) const
+	{
+		for (unsigned int c = 0; c < m_coarseSize; c++) {
+			unsigned int begin = c * m_coarsening;
+			unsigned int end = std::min(begin + m_coarsening, m_size);
+
+			T sum = 0;
+			for (unsigned int i = begin; i < end; i++)
+				sum += values[i+1];
+			coarseValues[c+1] = sum / (end - begin);
+		}
+		coarseValues[0] = coarseValues[m_coarseSize+1] = 0;
+	}
+
+	/**
+	 * Applies the boundary conditions (each engine gets its own copy, the
+	 * hydrographs keep a lookup position) and integrates
+	 */
+	void propagate(WavePropagation &wavePropagation, T startTime, T duration) const
+	{
+		wavePropagation.setBoundary(tools::Boundary::Left, m_boundaries[tools::Boundary::Left]);
+		wavePropagation.setBoundary(tools::Boundary::Right, m_boundaries[tools::Boundary::Right]);
+
+		T t = 0;
+		while (t < duration) {
+			wavePropagation.setBoundaryConditions(startTime + t);
+			T dt = std::min(wavePropagation.computeNumericalFluxes(), duration - t);
+			wavePropagation.updateUnknowns(dt);
+			t += dt;
+		}
+	}
+};
+
+#endif /* PARAREAL_H_ */
@@ -0,0 +1,62 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Initialization of the unknowns from a scenario.
+ *
+ *  All scenarios provide the same interface:
+ *  - <code>T getHeight(unsigned int pos)</code>,
+ *    <code>T getBathymetry(unsigned int pos)</code> for the cell pos
+ *  - <code>void fill(T *h, T *hu, T *b, unsigned int offset, unsigned int begin, unsigned int end)</code>
+ *    sets the initial values of the cells [begin, end), h[0] is the cell offset
+ *  - <code>T getCellSize()</code>
+ *
+ *  Scenarios that need other than outflow boundaries also provide
+ *  <code>tools::Boundary getBoundary(tools::Boundary::Side side)</code>.
+ */
+
+#ifndef SCENARIO_H_
+#define SCENARIO_H_
+
+#include "types.h"
+#include "tools/Partition.h"
+
+namespace scenarios
+{
+
+/**
+ * Sets the initial values of all cells in parallel.
+ *
+ * Each thread fills the cells it will update in WavePropagation. If the
+ * arrays are freshly allocated (e.g. with new T[]) and not touched
+ * before, their pages end up on the NUMA node of that thread.
+ *
+ * @param h water heights, size + 2 (incl. ghost cells)
+ * @param hu momentums, size + 2 (incl. ghost cells)
+ * @param b bathymetry, size + 2 (incl. ghost cells)
+ * @param size number of cells
+ * @param offset index of the first cell in the scenario (e.g. the first
+ *  cell of a slab in DistributedWavePropagation)
+ */
+template<class Scenario>
+void init(Scenario &scenario, T *h, T *hu, T *b, unsigned int size, unsigned int offset = 0)
+{
+#ifdef _OPENMP
+	#pragma omp parallel
+#endif
+	{
+		unsigned int begin, end;
+		tools::staticRange(size, begin, end);
+
+		// fill() uses the global index, h+1 is the cell offset
+		scenario.fill(h+1, hu+1, b+1, offset, offset+begin, offset+end);
+	}
+
+	// Ghost cells, set by the boundary conditions
+	h[0] = hu[0] = b[0] = 0;
+	h[size+1] = hu[size+1] = b[size+1] = 0;
+}
+
+}
+
+#endif /* SCENARIO_H_ */
@@ -0,0 +1,372 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Time loop of a simulation.
+ */
+
+#ifndef SIMULATOR_H_
+#define SIMULATOR_H_
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "types.h"
+#include "WavePropagation.h"
+#include "tools/HealthCheck.h"
+#include "tools/Instrumentation.h"
+#include "tools/ResultCache.h"
+#include "tools/SteadyState.h"
+#include "tools/Tracer.h"
+
+/**
+ * Runs a WavePropagation (or an engine with the same interface, e.g.
+ * AdaptiveWavePropagation) until the end time and writes checkpoints.
+ *
+ * The writer has to provide
+ * <code>void write(T time, const T *h, const T *hu, const T *b, unsigned int size)</code>
+ * where the arrays include the ghost cells.
+ *
+ * The ghost cells are set with the boundary conditions of the engine
+ * (see WavePropagation::setBoundary()).
+ *
+ * Rollbacks of the health check and the result cache need
+ * <code>void getState(std::vector<T> &state) const</code> and
+ * <code>void setState(const std::vector<T> &state)</code> in the engine,
+ * the health check also needs <code>T reduceMax(T value)</code> (see
+ * WavePropagation::getState() and WavePropagation::reduceMax()).
+ * <code>void synchronize()</code> is called before the state is checked
+ * or written (see DistributedWavePropagation::synchronize()).
+ */
+template<class Writer, class Engine = WavePropagation>
+class Simulator
+{
+public:
+	/** What happens once the flow is steady */
+	enum SteadyAction {
+		/** Write the current state and stop */
+		SteadyStop,
+		/** Continue, but only write every n-th checkpoint */
+		SteadyReduceOutput
+	};
+
+private:
+	Engine &m_wavePropagation;
+	Writer &m_writer;
+
+	/** Steady state detection, NULL if disabled */
+	tools::SteadyState *m_steadyState;
+	SteadyAction m_steadyAction;
+	/** Checkpoint interval after the flow is steady (SteadyReduceOutput) */
+	unsigned int m_steadyOutputInterval;
+
+	/** Health check, NULL if disabled */
+	tools::HealthCheck *m_healthCheck;
+	/** Time steps between two health checks */
+	unsigned int m_healthCheckInterval;
+	/** Number of rollbacks before the simulation is stopped */
+	unsigned int m_maxRollbacks;
+	unsigned int m_rollbacks;
+	/** Factor applied to the time steps, halved by each rollback */
+	T m_timeStepScale;
+
+	/** Last state that passed the health check */
+	std::vector<T> m_goodState;
+	T m_goodTime;
+	unsigned long m_goodSteps;
+
+	/** Result cache, NULL if disabled */
+	const tools::ResultCache *m_cache;
+	tools::ResultCache::Key m_cacheKey;
+	/** Number of states loaded from the cache */
+	unsigned int m_cacheHits;
+	/** Time of the last loaded state (not stored again) */
+	T m_loadedTime;
+
+	/** Simulated time */
+	T m_time;
+	/** Number of time steps */
+	unsigned long m_steps;
+
+public:
+	Simulator(Engine &wavePropagation, Writer &writer)
+		: m_wavePropagation(wavePropagation), m_writer(writer),
+		  m_steadyState(0L), m_steadyAction(SteadyStop), m_steadyOutputInterval(1),
+		  m_healthCheck(0L), m_healthCheckInterval(1), m_maxRollbacks(0), m_rollbacks(0),
+		  m_timeStepScale(1), m_goodTime(0), m_goodSteps(0),
+		  m_cache(0L), m_cacheHits(0), m_loadedTime(0),
+		  m_time(0), m_steps(0)
+	{
+	}
+
+	~Simulator()
+	{
+		delete m_steadyState;
+		delete m_healthCheck;
+	}
+
+	/**
+	 * Enable steady state detection
+	 *
+	 * @param tolerance see tools::SteadyState
+	 * @param window see tools::SteadyState
+	 * @param action what to do once the flow is steady
+	 * @param outputInterval only every outputInterval-th checkpoint is
+	 *  written once the flow is steady (SteadyReduceOutput only)
+	 */
+	void enableSteadyState(T tolerance, unsigned int window,
+			SteadyAction action = SteadyStop, unsigned int outputInterval = 10)
+	{
+		delete m_steadyState;
+		m_steadyState = new tools::SteadyState(tolerance, window);
+		m_steadyAction = action;
+		m_steadyOutputInterval = std::max(outputInterval, 1u);
+	}
+
+	/**
+	 * Enable the health check. It also runs before each checkpoint, so
+	 * only checked states are written.
+	 *
+	 * If a problem is found, it is reported to std::cerr. The simulation
+	 * is rolled back to the last checked state and continues with half
+	 * the time step (for the rest of the run), or stops with a
+	 * std::runtime_error after maxRollbacks rollbacks. With
+	 * DistributedWavePropagation, a problem on one rank rolls back all
+	 * ranks.
+	 *
+	 * @param healthCheck limits of the check (copied)
+	 * @param interval number of time steps between two checks
+	 * @param maxRollbacks 0 to stop at the first problem
+	 */
+	void enableHealthCheck(const tools::HealthCheck &healthCheck, unsigned int interval,
+			unsigned int maxRollbacks = 0)
+	{
+		delete m_healthCheck;
+		m_healthCheck = new tools::HealthCheck(healthCheck);
+		m_healthCheckInterval = std::max(interval, 1u);
+		m_maxRollbacks = maxRollbacks;
+
+		saveGoodState();
+	}
+
+	/**
+	 * Enable the result cache. Has to be called before the simulation
+	 * runs.
+	 *
+	 * Each checkpoint is stored in the cache. run() loads cached
+	 * checkpoints instead of computing them and continues from the latest
+	 * cached state before a missing checkpoint (e.g. if the end time
+	 * grows). The steady state detection starts over after loading a
+	 * state. Not for DistributedWavePropagation, the ranks may not find
+	 * the same states.
+	 *
+	 * @param cache the cache (not copied)
+	 * @param key key of the configuration, see tools::ResultCache::key()
+	 */
+	void enableCache(const tools::ResultCache &cache, const tools::ResultCache::Key &key)
+	{
+		if (m_time != 0)
+			throw std::logic_error("The result cache has to be enabled before the simulation runs");
+
+		m_cache = &cache;
+		m_cacheKey = key;
+	}
+
+	/**
+	 * Run the simulation
+	 *
+	 * @param endTime simulated time at which the simulation stops
+	 * @param numCheckpoints number of checkpoints (excl. the initial state)
+	 * @return Simulated time reached (less than endTime if stopped because
+	 *  the flow became steady)
+	 */
+	T run(T endTime, unsigned int numCheckpoints)
+	{
+		write();
+
+		for (unsigned int cp = 1; cp <= numCheckpoints; cp++) {
+			T checkpointTime = endTime * cp / numCheckpoints;
+
+			if (m_cache && m_time < checkpointTime)
+				loadFromCache(checkpointTime);
+
+			while (m_time < checkpointTime) {
+				TRACE_SCOPE("time_step");
+
+				m_wavePropagation.setBoundaryConditions(m_time);
+
+				T dt = m_wavePropagation.computeNumericalFluxes() * m_timeStepScale;
+				dt = std::min(dt, checkpointTime - m_time);
+				INSTR_TIME_STEP(dt);
+
+				m_wavePropagation.updateUnknowns(dt);
+				m_time += dt;
+				m_steps++;
+
+				if (m_healthCheck && (m_steps % m_healthCheckInterval == 0 || m_time >= checkpointTime)
+						&& !checkHealth(dt))
+					continue;
+
+				if (m_steadyState && !m_steadyState->isSteady()
+						&& m_steadyState->update(m_wavePropagation.getResidual())
+						&& m_steadyAction == SteadyStop) {
+					write();
+					INSTR_DUMP(std::cerr);
+					TRACE_FLUSH();
+					return m_time;
+				}
+			}
+
+			if (!isSteady() || cp % m_steadyOutputInterval == 0 || cp == numCheckpoints)
+				write();
+		}
+
+		INSTR_DUMP(std::cerr);
+		TRACE_FLUSH();
+
+		return m_time;
+	}
+
+	/**
+	 * @return True if steady state detection is enabled and the flow is steady
+	 */
+	bool isSteady() const
+	{
+		return m_steadyState && m_steadyState->isSteady();
+	}
+
+	/**
+	 * @return Simulated time
+	 */
+	T getTime() const
+	{
+		return m_time;
+	}
+
+	/**
+	 * @return Number of time steps computed so far
+	 */
+	unsigned long getSteps() const
+	{
+		return m_steps;
+	}
+
+	/**
+	 * @return Number of rollbacks of the health check
+	 */
+	unsigned int getRollbacks() const
+	{
+		return m_rollbacks;
+	}
+
+	/**
+	 * @return Number of states loaded from the result cache
+	 */
+	unsigned int getCacheHits() const
+	{
+		return m_cacheHits;
+	}
+
+private:
+	/**
+	 * Runs the health check and rolls back if necessary
+	 *
+	 * @param dt time step of the last step
+	 * @return True if the state is healthy, false after a rollback
+	 */
+	bool checkHealth(T dt)
+	{
+		TRACE_SCOPE("health_check");
+
+		m_wavePropagation.synchronize();
+
+		tools::HealthCheck::Report report = m_healthCheck->check(m_wavePropagation.getHeight(),
+			m_wavePropagation.getMomentum(), m_wavePropagation.getSize(), dt, m_steps);
+
+		// All ranks have to take the same decision
+		const bool healthy = report.problem == tools::HealthCheck::Healthy;
+		if (m_wavePropagation.reduceMax(healthy ? 0 : 1) == 0) {
+			saveGoodState();
+			return true;
+		}
+
+		std::ostringstream message;
+		if (healthy)
+			message << "Health check: problem on another rank";
+		else
+			message << "Health check: " << report;
+
+		if (m_rollbacks >= m_maxRollbacks)
+			throw std::runtime_error(message.str());
+
+		m_rollbacks++;
+		m_timeStepScale *= 0.5;
+		m_wavePropagation.setState(m_goodState);
+		m_time = m_goodTime;
+		m_steps = m_goodSteps;
+
+		std::cerr << message.str() << ", rolled back to step " << m_steps
+			<< " with time step factor " << m_timeStepScale << std::endl;
+		return false;
+	}
+
+	void saveGoodState()
+	{
+		m_wavePropagation.getState(m_goodState);
+		m_goodTime = m_time;
+		m_goodSteps = m_steps;
+	}
+
+	/**
+	 * Continues from the latest cached state up to checkpointTime, if
+	 * there is one after the current time
+	 */
+	void loadFromCache(T checkpointTime)
+	{
+		TRACE_SCOPE("cache");
+
+		T time = m_time;
+		if (!m_cache->latest(m_cacheKey, m_time, checkpointTime, time))
+			return;
+
+		// Same size as the stored state
+		std::vector<T> state;
+		m_wavePropagation.getState(state);
+		unsigned long steps;
+		if (!m_cache->load(m_cacheKey, time, state, steps))
+			return;
+
+		m_wavePropagation.setState(state);
+		m_time = time;
+		m_steps = steps;
+		m_cacheHits++;
+		m_loadedTime = time;
+
+		if (m_steadyState)
+			m_steadyState->reset();
+		if (m_healthCheck)
+			saveGoodState();
+	}
+
+	void write()
+	{
+		m_wavePropagation.synchronize();
+
+		INSTR_PHASE(Output);
+		TRACE_SCOPE("output");
+
+		m_writer.write(m_time, m_wavePropagation.getHeight(), m_wavePropagation.getMomentum(),
+			m_wavePropagation.getBathymetry(), m_wavePropagation.getSize());
+
+		if (m_cache && m_time > 0 && m_time != m_loadedTime) {
+			std::vector<T> state;
+			m_wavePropagation.getState(state);
+			m_cache->store(m_cacheKey, m_time, m_steps, state);
+		}
+	}
+};
+
+#endif /* SIMULATOR_H_ */
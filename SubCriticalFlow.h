@@ -1,7 +1,14 @@
 /**
- * This is a scenario to solve Exercise 2.1 of Assignment 2 
+ * This is a scenario to solve Exercise 2.1 of Assignment 2
  * SUBCRITICAL FLOW
  */
+
+#ifndef SCENARIOS_SUBCRITICALFLOW_H_
+#define SCENARIOS_SUBCRITICALFLOW_H_
+
+#include "types.h"
+#include "tools/Boundary.h"
+
 namespace scenarios
 {
 
@@ -10,6 +17,14 @@ private:
 	/** Number of cells */
 		const unsigned int m_size;
 
+  	// get the bathymerty at coordinate x
+  	// Formula (6)
+    T getBathymetryAt(T x) {
+    	if(x < 12 && x > 8)
+       		return (-1.8-0.05*((x-10)*(x-10))) ;
+       	else
+       		return -2;
+    };
 
   public:
 	SubCriticalFlow(unsigned int size)
@@ -17,35 +32,57 @@ private:
 	{
 	}
 
-  	// get the bathymerty at Position x 
-  	// Formula (6)
-    float getBathymetry(float x) {
-    	if(x < 12 && x > 8)
-       		return (-1.8-0.05*((x-10)*(x-10))) ;
-       	else
-       		return -2;
+	// get the bathymetry at cell pos
+    T getBathymetry(unsigned int pos) {
+    	return getBathymetryAt((pos + 0.5f) * getCellSize());
     };
 
-    // get the waterheight at Position x
+    // get the waterheight at cell pos
 
-    float getHeight(float x) {
+    T getHeight(unsigned int pos) {
 
-    	return -getBathymetry(x);
-      	/* if(x < 12 && x > 8)
-       		return (-(-1.8-0.05*((x-10)*(x-10)))) ;
-       	else
-       		return 2;*/
+    	return -getBathymetry(pos);
 
     };
 
 
-    // get the velocity at Position x
+    // get the velocity at cell pos
 
-	 float getVelocity(float x) {
+	 T getVelocity(unsigned int pos) {
 
-	 	return 4.42/getHeight(x);
+	 	return 4.42f/getHeight(pos);
 
 	 };
+
+	/**
+	 * Initial values of the cells [begin, end)
+	 *
+	 * @param h water heights of the cells from offset on (without ghost cells)
+	 * @param hu momentums of the cells from offset on
+	 * @param b bathymetry of the cells from offset on
+	 * @param offset global index of h[0], hu[0] and b[0]
+	 */
+	void fill(T *h, T *hu, T *b, unsigned int offset, unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++) {
+			b[i-offset] = getBathymetry(i);
+			h[i-offset] = -b[i-offset];
+			// Constant discharge
+			hu[i-offset] = 4.42f;
+		}
+	}
+
+	 /**
+	  * @return Boundary condition of one end: the constant discharge
+	  *  flows in on the left and out on the right
+	  */
+	 tools::Boundary getBoundary(tools::Boundary::Side side)
+	 {
+	    if (side == tools::Boundary::Left)
+	       return tools::Boundary::inflow(4.42f);
+	    return tools::Boundary::outflow();
+	 }
+
 	 /**
 	 * @return Cell size of one cell (= domain size/number of cells)
 	 */
@@ -53,16 +90,25 @@ private:
 	 {
 	    return 1000.f / m_size;
 	 }
-};
-}
-/* get the number of timesteps for the current scenario
-
-	 float getTimesteps() {
 
-	 	return 200;
-
-	 }*/
+	 /**
+	  * @return Residual (see WavePropagation::getResidual()) below which
+	  *  the flow is considered steady
+	  */
+	 T getSteadyStateTolerance()
+	 {
+	    return 1e-4;
+	 }
 
+	 /**
+	  * @return Number of consecutive time steps the residual has to stay
+	  *  below the tolerance
+	  */
+	 unsigned int getSteadyStateWindow()
+	 {
+	    return 100;
+	 }
+};
+}
 
-    
-   
+#endif /* SCENARIOS_SUBCRITICALFLOW_H_ */
@@ -2,65 +2,113 @@
  * This is a scenario to solve Exercise 2.2 of Assignment 2
  * SUPERCRITICAL FLOW
  */
+
+#ifndef SCENARIOS_SUPERCRITICALFLOW_H_
+#define SCENARIOS_SUPERCRITICALFLOW_H_
+
+#include "types.h"
+#include "tools/Boundary.h"
+
 namespace scenarios
 {
+
 class SuperCriticalFlow{
 private:
 	/** Number of cells */
 		const unsigned int m_size;
 
-  public:
-		SuperCriticalFlow(unsigned int size)
-				: m_size(size)
-			{
-			}
-
-  	// get the bathymerty at Position x 
+  	// get the bathymerty at coordinate x
   	// Formula (6)
-    float getBathymetry(float x) {
+    T getBathymetryAt(T x) {
     	if(x <= 12 && x >= 8)
        		return (-0.13-0.05*((x-10)*(x-10))) ;
        	else
        		return -0.33;
     };
 
-    // get the waterheight at Position x
+  public:
+	SuperCriticalFlow(unsigned int size)
+		: m_size(size)
+	{
+	}
+
+	// get the bathymetry at cell pos
+    T getBathymetry(unsigned int pos) {
+    	return getBathymetryAt((pos + 0.5f) * getCellSize());
+    };
 
-    float getHeight(float x) {
+    // get the waterheight at cell pos
 
-    	return -getBathymetry(x);
-      	/* if(x <= 12 && x >= 8)
-       		return (-(-0.13-0.05*((x-10)*(x-10)))) ;
-       	else
-       		return 0.33;*/
+    T getHeight(unsigned int pos) {
+
+    	return -getBathymetry(pos);
 
     };
 
 
-    // get the momentum at Position x
+    // get the velocity at cell pos
 
-	 float getVelocity(float x) {
+	 T getVelocity(unsigned int pos) {
 
-	 	return 0.18/getHeight(x);
+	 	return 0.18f/getHeight(pos);
+
+	 };
+
+	/**
+	 * Initial values of the cells [begin, end)
+	 *
+	 * @param h water heights of the cells from offset on (without ghost cells)
+	 * @param hu momentums of the cells from offset on
+	 * @param b bathymetry of the cells from offset on
+	 * @param offset global index of h[0], hu[0] and b[0]
+	 */
+	void fill(T *h, T *hu, T *b, unsigned int offset, unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++) {
+			b[i-offset] = getBathymetry(i);
+			h[i-offset] = -b[i-offset];
+			// Constant discharge
+			hu[i-offset] = 0.18f;
+		}
+	}
 
-	 }
 	 /**
-	  * @return Cell size of one cell (= domain size/number of cells)
+	  * @return Boundary condition of one end: the constant discharge
+	  *  flows in on the left and out on the right
 	  */
-	  T getCellSize()
+	 tools::Boundary getBoundary(tools::Boundary::Side side)
+	 {
+	    if (side == tools::Boundary::Left)
+	       return tools::Boundary::inflow(0.18f);
+	    return tools::Boundary::outflow();
+	 }
+
+	 /**
+	 * @return Cell size of one cell (= domain size/number of cells)
+	 */
+	 T getCellSize()
+	 {
+	    return 1000.f / m_size;
+	 }
+
+	  /**
+	   * @return Residual (see WavePropagation::getResidual()) below which
+	   *  the flow is considered steady
+	   */
+	  T getSteadyStateTolerance()
+	  {
+	     return 1e-4;
+	  }
+
+	  /**
+	   * @return Number of consecutive time steps the residual has to stay
+	   *  below the tolerance
+	   */
+	  unsigned int getSteadyStateWindow()
 	  {
-	     return 1000.f / m_size;
+	     return 100;
 	  }
 };
 }
-/* get the number of timesteps for the current scenario
-
-	 float getTimesteps() {
-
-	 	return 200;
-
-	 }*/
-
 
-    
-   
+#endif /* SCENARIOS_SUPERCRITICALFLOW_H_ */
@@ -0,0 +1,815 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Wave propagation engine: computes the net updates on all edges with
+ *  solver::FWave and applies them to the cells.
+ */
+
+#ifndef WAVEPROPAGATION_H_
+#define WAVEPROPAGATION_H_
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#include "types.h"
+#include "solvers/FWave.hpp"
+#include "solvers/Hybrid.hpp"
+#include "tools/Arena.h"
+#include "tools/Boundary.h"
+#include "tools/Instrumentation.h"
+#include "tools/Partition.h"
+#include "tools/Reduction.h"
+#include "tools/Tracer.h"
+
+class WavePropagation
+{
+public:
+	/** Solver used for the net updates */
+	enum Kernel {
+		/** solver::FWave on all edges */
+		KernelFWave,
+		/** solver::Hybrid (Rusanov on smooth edges, FWave elsewhere) */
+		KernelHybrid
+	};
+
+private:
+	/** Water heights, size + 2 (incl. ghost cells) */
+	T *m_h;
+	/** Momentums, size + 2 (incl. ghost cells) */
+	T *m_hu;
+	/** Bathymetry, size + 2 (incl. ghost cells) */
+	T *m_b;
+
+	/** Net updates of all edges, size + 1 */
+	T *m_hNetUpdatesLeft;
+	T *m_hNetUpdatesRight;
+	T *m_huNetUpdatesLeft;
+	T *m_huNetUpdatesRight;
+
+	/** Number of cells (without ghost cells) */
+	const unsigned int m_size;
+	/** Size of one cell */
+	const T m_cellSize;
+
+	/** Mean absolute rate of change of h and hu in the last update */
+	T m_residual;
+
+	/** Fraction of the largest stable time step that is used */
+	T m_cflNumber;
+
+	/** True if the net update arrays are allocated with new[] */
+	const bool m_ownsNetUpdates;
+
+	/** Concentrations of the passive tracers, numTracers * (size + 2) */
+	T *m_tracers;
+	unsigned int m_numTracers;
+	/**
+	 * Upwind tracer fluxes through all edges, numTracers * (size + 1),
+	 * seen from the left and from the right cell
+	 */
+	T *m_tracerFluxesLeft;
+	T *m_tracerFluxesRight;
+
+	/**
+	 * Wet/dry bitmap: bit i % 64 of word i / 64 is set if cell i is wet.
+	 * Empty if disabled.
+	 */
+	std::vector<uint64_t> m_wetCells;
+
+	/** Boundary conditions of the left and the right end */
+	tools::Boundary m_boundaries[2];
+
+	/** True if the sums do not depend on the number of threads */
+	bool m_reproducible;
+	/** Partial sums of the chunks in reproducible mode */
+	std::vector<T> m_partialSums;
+	/** Maximum wave speed or residual of each thread */
+	tools::ThreadValues<T> m_threadValues;
+
+	Kernel m_kernel;
+	solver::FWave<T> m_solver;
+	solver::Hybrid<T> m_hybridSolver;
+
+public:
+	/**
+	 * @param h water heights, size + 2
+	 * @param hu momentums, size + 2
+	 * @param b bathymetry, size + 2
+	 * @param size number of cells
+	 * @param cellSize size of one cell
+	 */
+	WavePropagation(T *h, T *hu, T *b, unsigned int size, T cellSize)
+		: m_h(h), m_hu(hu), m_b(b),
+		  m_size(size), m_cellSize(cellSize),
+		  m_residual(0), m_cflNumber(0.4), m_ownsNetUpdates(true),
+		  m_tracers(0L), m_numTracers(0), m_tracerFluxesLeft(0L), m_tracerFluxesRight(0L),
+		  m_reproducible(false), m_kernel(KernelFWave)
+	{
+		m_hNetUpdatesLeft = new T[size+1];
+		m_hNetUpdatesRight = new T[size+1];
+		m_huNetUpdatesLeft = new T[size+1];
+		m_huNetUpdatesRight = new T[size+1];
+	}
+
+	/**
+	 * Takes the net update arrays from an arena. They are first touched
+	 * by the edge sweep and thus placed NUMA-local to the computing threads.
+	 *
+	 * @param arena needs at least arenaBytes(size) free bytes
+	 */
+	WavePropagation(T *h, T *hu, T *b, unsigned int size, T cellSize, tools::Arena &arena)
+		: m_h(h), m_hu(hu), m_b(b),
+		  m_size(size), m_cellSize(cellSize),
+		  m_residual(0), m_cflNumber(0.4), m_ownsNetUpdates(false),
+		  m_tracers(0L), m_numTracers(0), m_tracerFluxesLeft(0L), m_tracerFluxesRight(0L),
+		  m_reproducible(false), m_kernel(KernelFWave)
+	{
+		m_hNetUpdatesLeft = arena.allocate<T>(size+1);
+		m_hNetUpdatesRight = arena.allocate<T>(size+1);
+		m_huNetUpdatesLeft = arena.allocate<T>(size+1);
+		m_huNetUpdatesRight = arena.allocate<T>(size+1);
+	}
+
+	~WavePropagation()
+	{
+		if (m_ownsNetUpdates) {
+			delete [] m_hNetUpdatesLeft;
+			delete [] m_hNetUpdatesRight;
+			delete [] m_huNetUpdatesLeft;
+			delete [] m_huNetUpdatesRight;
+		}
+		delete [] m_tracerFluxesLeft;
+		delete [] m_tracerFluxesRight;
+	}
+
+	/**
+	 * Select the solver for the net updates (default: KernelFWave)
+	 */
+	void setKernel(Kernel kernel)
+	{
+		m_kernel = kernel;
+	}
+
+	Kernel getKernel() const
+	{
+		return m_kernel;
+	}
+
+	/**
+	 * Transport passive tracers (e.g. pollutant or sediment concentrations)
+	 * with the flow.
+	 *
+	 * The tracers are advected with the mass fluxes of the net updates
+	 * (first order upwind), so they cost no additional Riemann solve. A
+	 * constant concentration stays constant and the tracer mass is
+	 * conserved except in cells that fall dry.
+	 *
+	 * @param tracers concentrations, tracer k in tracers[k*(size+2) .. (k+1)*(size+2))
+	 *  (incl. ghost cells)
+	 * @param numTracers number of tracers, 0 to disable
+	 */
+	void setTracers(T *tracers, unsigned int numTracers)
+	{
+		delete [] m_tracerFluxesLeft;
+		delete [] m_tracerFluxesRight;
+
+		m_tracers = tracers;
+		m_numTracers = numTracers;
+		m_tracerFluxesLeft = m_tracerFluxesRight = 0L;
+		if (numTracers) {
+			m_tracerFluxesLeft = new T[numTracers * (m_size+1)];
+			m_tracerFluxesRight = new T[numTracers * (m_size+1)];
+		}
+	}
+
+	/**
+	 * Keep a bitmap of the wet cells to skip dry regions.
+	 *
+	 * Dry cells never change (both solvers keep them dry), so blocks of
+	 * 64 edges between dry cells are neither loaded nor solved, and dry
+	 * cells are not updated. The bitmap is updated when cells fall dry.
+	 * Pays off for domains with large dry areas.
+	 */
+	void setDryBitmap(bool enable)
+	{
+		if (enable) {
+			m_wetCells.resize((m_size + 2 + 63) / 64);
+			updateDryBitmap();
+		} else {
+			m_wetCells.clear();
+		}
+	}
+
+	/**
+	 * Rebuilds the wet/dry bitmap. Has to be called if the water heights
+	 * are modified outside of this class (except for the ghost cells).
+	 */
+	void updateDryBitmap()
+	{
+		const unsigned int numWords = m_wetCells.size();
+
+#ifdef _OPENMP
+		#pragma omp parallel for schedule(static)
+#endif
+		for (unsigned int w = 0; w < numWords; w++) {
+			uint64_t wet = 0;
+			unsigned int end = std::min(64*w + 64, m_size+2);
+			for (unsigned int i = 64*w; i < end; i++)
+				wet |= static_cast<uint64_t>(m_h[i] >= solver::FWave<T>::dryTol) << (i % 64);
+			m_wetCells[w] = wet;
+		}
+	}
+
+	/**
+	 * Make the results bitwise identical for any number of threads.
+	 *
+	 * The cells and the maximum wave speed do not depend on the number of
+	 * threads anyway. The sums (residual, getMass()) use fixed chunks and
+	 * a fixed summation order instead of an OpenMP reduction (see
+	 * tools/Reduction.h), which costs an additional pass over the partial
+	 * sums. Needed for certified runs: the residual decides when
+	 * tools::SteadyState stops the simulation.
+	 */
+	void setReproducible(bool reproducible)
+	{
+		m_reproducible = reproducible;
+	}
+
+	bool isReproducible() const
+	{
+		return m_reproducible;
+	}
+
+	/**
+	 * Set the CFL number (default: 0.4). FWave is stable up to 1.
+	 */
+	void setCflNumber(T cflNumber)
+	{
+		m_cflNumber = cflNumber;
+	}
+
+	T getCflNumber() const
+	{
+		return m_cflNumber;
+	}
+
+	T getCellSize() const
+	{
+		return m_cellSize;
+	}
+
+	/**
+	 * @return Bytes of the arrays taken from an arena
+	 */
+	static size_t arenaBytes(unsigned int size)
+	{
+		return 4 * tools::Arena::bytes<T>(size+1);
+	}
+
+	/**
+	 * Computes the net updates on all edges.
+	 *
+	 * @return Maximum allowed time step (CFL condition)
+	 */
+	T computeNumericalFluxes()
+	{
+		return m_cellSize / computeNetUpdates(0, m_size+1) * m_cflNumber;
+	}
+
+	/**
+	 * Computes the net updates on the edges [begin, end). Small ranges are
+	 * computed by the calling thread only.
+	 *
+	 * @return Maximum wave speed of these edges
+	 */
+	T computeNetUpdates(unsigned int begin, unsigned int end)
+	{
+		{
+			INSTR_PHASE(EdgeSolve);
+			TRACE_SCOPE("edge_sweep");
+
+			if (!m_wetCells.empty()) {
+				// The ghost cells are set by the boundary conditions
+				setWet(0, m_h[0] >= solver::FWave<T>::dryTol);
+				setWet(m_size+1, m_h[m_size+1] >= solver::FWave<T>::dryTol);
+			}
+
+			m_threadValues.reset(0);
+
+#ifdef _OPENMP
+			#pragma omp parallel if(end - begin > 1024)
+#endif
+			{
+				{
+					TRACE_SCOPE("edge_chunk");
+
+					unsigned int first, last;
+					tools::staticRange(end - begin, first, last);
+					first += begin;
+					last += begin;
+
+					T maxWaveSpeed = 0;
+
+					if (!m_wetCells.empty()) {
+						for (unsigned int block = first; block < last; ) {
+							unsigned int w = block / 64;
+							unsigned int blockEnd = std::min(64*w + 64, last);
+
+							// The edges of word w connect the cells 64w .. 64w + 64
+							if (m_wetCells[w] == 0 && !isWet(64*w + 64)) {
+								INSTR_COUNT(DryBlocksSkipped);
+							} else {
+								maxWaveSpeed = std::max(maxWaveSpeed, solveEdges(block, blockEnd));
+								if (m_numTracers)
+									computeTracerFluxes(block, blockEnd);
+							}
+
+							block = blockEnd;
+						}
+					} else if (m_numTracers == 0) {
+						maxWaveSpeed = solveEdges(first, last);
+					} else {
+						// Compute the tracer fluxes while the net updates are in the cache
+						for (unsigned int block = first; block < last; block += tracerBlockSize) {
+							unsigned int blockEnd = std::min(block + tracerBlockSize, last);
+							maxWaveSpeed = std::max(maxWaveSpeed, solveEdges(block, blockEnd));
+							computeTracerFluxes(block, blockEnd);
+						}
+					}
+
+					m_threadValues.set(maxWaveSpeed);
+				}
+
+				TRACE_BARRIER();
+			}
+		}
+
+		INSTR_PHASE(Reduction);
+		return m_threadValues.max();
+	}
+
+	/**
+	 * Updates the unknowns with the net updates of the last call to
+	 * computeNumericalFluxes().
+	 *
+	 * The residual (see getResidual()) is accumulated in the same loop.
+	 *
+	 * @param dt time step
+	 */
+	void updateUnknowns(T dt)
+	{
+		{
+			INSTR_PHASE(CellUpdate);
+			TRACE_SCOPE("cell_update");
+
+			// Needs the old heights
+			if (m_numTracers)
+				updateTracers(dt);
+
+			if (m_reproducible) {
+				// Chunks of whole bitmap words (cells incl. the left ghost cell)
+				const unsigned int numChunks = tools::numReductionChunks(m_size+1);
+				m_partialSums.resize(numChunks);
+
+#ifdef _OPENMP
+				#pragma omp parallel
+#endif
+				{
+					{
+						TRACE_SCOPE("cell_chunk");
+
+#ifdef _OPENMP
+						#pragma omp for schedule(static) nowait
+#endif
+						for (unsigned int c = 0; c < numChunks; c++) {
+							unsigned int begin, end;
+							tools::reductionChunk(c, m_size+1, begin, end);
+							m_partialSums[c] = updateCells(begin, end, dt);
+						}
+					}
+
+					TRACE_BARRIER();
+				}
+			} else {
+				m_threadValues.reset(0);
+
+#ifdef _OPENMP
+				#pragma omp parallel
+#endif
+				{
+					{
+						TRACE_SCOPE("cell_chunk");
+
+						T residual = 0;
+
+						if (!m_wetCells.empty()) {
+							const unsigned int numWords = m_wetCells.size();
+
+#ifdef _OPENMP
+							#pragma omp for schedule(static) nowait
+#endif
+							for (unsigned int w = 0; w < numWords; w++)
+								residual += updateWetCells(w, dt);
+						} else {
+#ifdef _OPENMP
+							#pragma omp for schedule(static) nowait
+#endif
+							for (unsigned int i = 1; i < m_size+1; i++)
+								residual += updateCell(i, dt);
+						}
+
+						m_threadValues.set(residual);
+					}
+
+					TRACE_BARRIER();
+				}
+			}
+		}
+
+		INSTR_PHASE(Reduction);
+
+		T residual;
+		if (m_reproducible)
+			residual = tools::treeSum(&m_partialSums[0], m_partialSums.size());
+		else
+			residual = m_threadValues.sum();
+
+		m_residual = residual / (m_cellSize * m_size);
+	}
+
+	/**
+	 * Saves everything that changes during the simulation, e.g. to roll
+	 * back to this state with setState()
+	 *
+	 * @param state output, h, hu and the tracers (size + 2 each, incl.
+	 *  ghost cells)
+	 */
+	void getState(std::vector<T> &state) const
+	{
+		state.resize((2 + m_numTracers) * (m_size+2));
+		std::copy(m_h, m_h + m_size+2, state.begin());
+		std::copy(m_hu, m_hu + m_size+2, state.begin() + (m_size+2));
+		std::copy(m_tracers, m_tracers + m_numTracers*(m_size+2), state.begin() + 2*(m_size+2));
+	}
+
+	/**
+	 * Overwrites the unknowns and the tracers, e.g. to roll back to an
+	 * earlier state
+	 *
+	 * @param state saved by getState() with the same size and number of
+	 *  tracers
+	 */
+	void setState(const std::vector<T> &state)
+	{
+		if (state.size() != (2 + m_numTracers) * (m_size+2))
+			throw std::invalid_argument("The state does not match the size or the number of tracers");
+
+		std::copy(state.begin(), state.begin() + (m_size+2), m_h);
+		std::copy(state.begin() + (m_size+2), state.begin() + 2*(m_size+2), m_hu);
+		std::copy(state.begin() + 2*(m_size+2), state.end(), m_tracers);
+
+		if (!m_wetCells.empty())
+			updateDryBitmap();
+	}
+
+	/**
+	 * @return Maximum of value on all ranks, i.e. value itself (see
+	 *  DistributedWavePropagation::reduceMax())
+	 */
+	T reduceMax(T value) const
+	{
+		return value;
+	}
+
+	/**
+	 * Nothing to do, the state is always final (see
+	 * DistributedWavePropagation::synchronize())
+	 */
+	void synchronize()
+	{
+	}
+
+	/**
+	 * Set the boundary condition of one end (default: outflow), used by
+	 * setBoundaryConditions()
+	 */
+	void setBoundary(tools::Boundary::Side side, const tools::Boundary &boundary)
+	{
+		m_boundaries[side] = boundary;
+	}
+
+	const tools::Boundary& getBoundary(tools::Boundary::Side side) const
+	{
+		return m_boundaries[side];
+	}
+
+	/**
+	 * Fills the ghost cells with the boundary conditions set by
+	 * setBoundary(). The tracers have zero gradient boundaries.
+	 *
+	 * @param time simulated time (for hydrographs)
+	 */
+	void setBoundaryConditions(T time)
+	{
+		INSTR_PHASE(Boundary);
+		TRACE_SCOPE("boundary");
+
+		m_boundaries[tools::Boundary::Left].apply(time, m_h, m_hu, m_b, m_size, tools::Boundary::Left);
+		m_boundaries[tools::Boundary::Right].apply(time, m_h, m_hu, m_b, m_size, tools::Boundary::Right);
+
+		for (unsigned int k = 0; k < m_numTracers; k++) {
+			T *c = m_tracers + k*(m_size+2);
+			c[0] = c[1]; c[m_size+1] = c[m_size];
+		}
+	}
+
+	/**
+	 * Sets outflow boundary conditions in the ghost cells (independent of
+	 * setBoundary())
+	 */
+	void setOutflowBoundaryConditions()
+	{
+		INSTR_PHASE(Boundary);
+		TRACE_SCOPE("boundary");
+
+		m_h[0] = m_h[1]; m_h[m_size+1] = m_h[m_size];
+		m_hu[0] = m_hu[1]; m_hu[m_size+1] = m_hu[m_size];
+		m_b[0] = m_b[1]; m_b[m_size+1] = m_b[m_size];
+
+		for (unsigned int k = 0; k < m_numTracers; k++) {
+			T *c = m_tracers + k*(m_size+2);
+			c[0] = c[1]; c[m_size+1] = c[m_size];
+		}
+	}
+
+	/**
+	 * @return Mean of |dh/dt| + |dhu/dt| over all cells in the last update.
+	 *  Goes to zero when the flow becomes steady.
+	 */
+	T getResidual() const
+	{
+		return m_residual;
+	}
+
+	/**
+	 * @return Water volume (per unit width) of all cells, for conservation
+	 *  checks. Reproducible if setReproducible() is enabled.
+	 */
+	T getMass() const
+	{
+		T mass = 0;
+
+		if (m_reproducible) {
+			const unsigned int numChunks = tools::numReductionChunks(m_size);
+			std::vector<T> partialSums(numChunks);
+
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(static)
+#endif
+			for (unsigned int c = 0; c < numChunks; c++) {
+				unsigned int begin, end;
+				tools::reductionChunk(c, m_size, begin, end);
+
+				T sum = 0;
+				for (unsigned int i = begin; i < end; i++)
+					sum += m_h[i+1];
+				partialSums[c] = sum;
+			}
+
+			mass = tools::treeSum(&partialSums[0], numChunks);
+		} else {
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(static) reduction(+:mass)
+#endif
+			for (unsigned int i = 1; i < m_size+1; i++)
+				mass += m_h[i];
+		}
+
+		return mass * m_cellSize;
+	}
+
+	/**
+	 * @return Water heights, size + 2 (incl. ghost cells)
+	 */
+	const T* getHeight() const
+	{
+		return m_h;
+	}
+
+	/**
+	 * @return Momentums, size + 2 (incl. ghost cells)
+	 */
+	const T* getMomentum() const
+	{
+		return m_hu;
+	}
+
+	/**
+	 * @return Bathymetry, size + 2 (incl. ghost cells)
+	 */
+	const T* getBathymetry() const
+	{
+		return m_b;
+	}
+
+	/**
+	 * Net updates of one edge from the last call to computeNumericalFluxes()
+	 *
+	 * @param edge the edge between cell edge and edge + 1 (incl. ghost cells)
+	 */
+	void getNetUpdates(unsigned int edge, T &hLeft, T &hRight, T &huLeft, T &huRight) const
+	{
+		hLeft = m_hNetUpdatesLeft[edge];
+		hRight = m_hNetUpdatesRight[edge];
+		huLeft = m_huNetUpdatesLeft[edge];
+		huRight = m_huNetUpdatesRight[edge];
+	}
+
+	/**
+	 * @return Number of cells (without ghost cells)
+	 */
+	unsigned int getSize() const
+	{
+		return m_size;
+	}
+
+private:
+	/** Edges per block when tracer fluxes are computed */
+	static const unsigned int tracerBlockSize = 1024;
+
+	/**
+	 * Updates one cell
+	 *
+	 * @return Absolute change (for the residual)
+	 */
+	T updateCell(unsigned int i, T dt)
+	{
+		T dh = m_hNetUpdatesRight[i-1] + m_hNetUpdatesLeft[i];
+		T dhu = m_huNetUpdatesRight[i-1] + m_huNetUpdatesLeft[i];
+
+		m_h[i] -= dt/m_cellSize * dh;
+		m_hu[i] -= dt/m_cellSize * dhu;
+
+		return std::fabs(dh) + std::fabs(dhu);
+	}
+
+	/**
+	 * Updates the cells [begin, end) serially. With the wet/dry bitmap,
+	 * begin and end have to be multiples of 64 (or the last cell + 1).
+	 *
+	 * @return Sum of the absolute changes
+	 */
+	T updateCells(unsigned int begin, unsigned int end, T dt)
+	{
+		T residual = 0;
+
+		if (!m_wetCells.empty()) {
+			for (unsigned int w = begin / 64; w < (end + 63) / 64; w++)
+				residual += updateWetCells(w, dt);
+		} else {
+			for (unsigned int i = std::max(begin, 1u); i < end; i++)
+				residual += updateCell(i, dt);
+		}
+
+		return residual;
+	}
+
+	/**
+	 * Updates only the wet cells of bitmap word w and clears the bits of
+	 * cells that fall dry. The net updates next to dry cells may be
+	 * outdated (skipped edges), but dry cells do not change anyway.
+	 *
+	 * @return Sum of the absolute changes
+	 */
+	T updateWetCells(unsigned int w, T dt)
+	{
+		uint64_t wet = m_wetCells[w];
+		if (wet == 0)
+			return 0;
+
+		unsigned int begin = std::max(64*w, 1u);
+		unsigned int end = std::min(64*w + 64, m_size+1);
+		T residual = 0;
+
+		if (wet == ~static_cast<uint64_t>(0)) {
+			for (unsigned int i = begin; i < end; i++)
+				residual += updateCell(i, dt);
+		} else {
+			for (unsigned int i = begin; i < end; i++) {
+				if (wet >> (i % 64) & 1)
+					residual += updateCell(i, dt);
+			}
+		}
+
+		for (unsigned int i = begin; i < end; i++) {
+			if (m_h[i] < solver::FWave<T>::dryTol)
+				wet &= ~(static_cast<uint64_t>(1) << (i % 64));
+		}
+		m_wetCells[w] = wet;
+
+		return residual;
+	}
+
+	/**
+	 * @return True if cell is wet in the bitmap (false outside of the domain)
+	 */
+	bool isWet(unsigned int cell) const
+	{
+		return cell < m_size+2 && (m_wetCells[cell / 64] >> (cell % 64) & 1);
+	}
+
+	void setWet(unsigned int cell, bool wet)
+	{
+		uint64_t bit = static_cast<uint64_t>(1) << (cell % 64);
+		if (wet)
+			m_wetCells[cell / 64] |= bit;
+		else
+			m_wetCells[cell / 64] &= ~bit;
+	}
+
+	/**
+	 * Runs the selected solver on the edges [begin, end)
+	 *
+	 * @return Maximum wave speed
+	 */
+	T solveEdges(unsigned int begin, unsigned int end)
+	{
+		if (m_kernel == KernelHybrid)
+			return m_hybridSolver.computeNetUpdates(m_h+begin, m_hu+begin, m_b+begin, end-begin,
+				m_hNetUpdatesLeft+begin, m_hNetUpdatesRight+begin,
+				m_huNetUpdatesLeft+begin, m_huNetUpdatesRight+begin);
+
+		return m_solver.computeNetUpdates(m_h+begin, m_hu+begin, m_b+begin, end-begin,
+			m_hNetUpdatesLeft+begin, m_hNetUpdatesRight+begin,
+			m_huNetUpdatesLeft+begin, m_huNetUpdatesRight+begin);
+	}
+
+	/**
+	 * Computes the upwind tracer fluxes of the edges [begin, end).
+	 *
+	 * The height net updates are the mass flux differences to the
+	 * neighbouring cells, so the mass flux through the edge is
+	 * hu_l + hNetUpdatesLeft (seen from the left cell) or
+	 * hu_r - hNetUpdatesRight (seen from the right cell). Both are equal
+	 * except at wet/dry edges.
+	 */
+	void computeTracerFluxes(unsigned int begin, unsigned int end)
+	{
+		for (unsigned int k = 0; k < m_numTracers; k++) {
+			const T *c = m_tracers + k*(m_size+2);
+			T *fluxLeft = m_tracerFluxesLeft + k*(m_size+1);
+			T *fluxRight = m_tracerFluxesRight + k*(m_size+1);
+
+			for (unsigned int i = begin; i < end; i++) {
+				T massFluxLeft = m_hu[i] + m_hNetUpdatesLeft[i];
+				T massFluxRight = m_hu[i+1] - m_hNetUpdatesRight[i];
+
+				fluxLeft[i] = massFluxLeft * (massFluxLeft > 0 ? c[i] : c[i+1]);
+				fluxRight[i] = massFluxRight * (massFluxRight > 0 ? c[i] : c[i+1]);
+			}
+		}
+	}
+
+	/**
+	 * Updates the tracer concentrations. Has to be called before the
+	 * heights are updated.
+	 */
+	void updateTracers(T dt)
+	{
+#ifdef _OPENMP
+		#pragma omp parallel
+#endif
+		{
+			{
+				TRACE_SCOPE("tracer_chunk");
+
+				// The tracers are independent, no barrier in between
+				for (unsigned int k = 0; k < m_numTracers; k++) {
+					T *c = m_tracers + k*(m_size+2);
+					const T *fluxLeft = m_tracerFluxesLeft + k*(m_size+1);
+					const T *fluxRight = m_tracerFluxesRight + k*(m_size+1);
+
+#ifdef _OPENMP
+					#pragma omp for schedule(static) nowait
+#endif
+					for (unsigned int i = 1; i < m_size+1; i++) {
+						// Same as in updateUnknowns()
+						T h = m_h[i] - dt/m_cellSize * (m_hNetUpdatesRight[i-1] + m_hNetUpdatesLeft[i]);
+						T hc = m_h[i] * c[i] - dt/m_cellSize * (fluxLeft[i] - fluxRight[i-1]);
+
+						// Dry cells stay dry (their net updates may be outdated, see setDryBitmap())
+						c[i] = (m_h[i] < solver::FWave<T>::dryTol || h < solver::FWave<T>::dryTol ? 0 : hc / h);
+					}
+				}
+			}
+
+			TRACE_BARRIER();
+		}
+	}
+};
+
+#endif /* WAVEPROPAGATION_H_ */
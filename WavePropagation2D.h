@@ -0,0 +1,521 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Two-dimensional wave propagation with dimensional splitting: the 1D
+ *  edge solvers are applied to all rows (x-sweep) and afterwards to all
+ *  columns (y-sweep) of the grid.
+ *
+ *  The arrays are stored row by row (x is the fast index). The x-sweep
+ *  runs the batched kernels directly on the rows. For the y-sweep, tiles
+ *  of a few columns are copied (transposed) into small per-thread
+ *  buffers, so the kernels again work on contiguous data and each cache
+ *  line of the grid is loaded only once per sweep.
+ */
+
+#ifndef WAVEPROPAGATION2D_H_
+#define WAVEPROPAGATION2D_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "types.h"
+#include "WavePropagation.h"
+#include "solvers/FWave.hpp"
+#include "solvers/Hybrid.hpp"
+#include "tools/Instrumentation.h"
+#include "tools/Reduction.h"
+#include "tools/Tracer.h"
+
+class WavePropagation2D
+{
+private:
+	/** Water heights, (nx + 2) * (ny + 2) (incl. ghost cells) */
+	T *m_h;
+	/** Momentums in x direction */
+	T *m_hu;
+	/** Momentums in y direction */
+	T *m_hv;
+	/** Bathymetry */
+	T *m_b;
+
+	/** Net updates of the x-sweep, (nx + 1) * ny */
+	T *m_hNetUpdatesLeft;
+	T *m_hNetUpdatesRight;
+	T *m_huNetUpdatesLeft;
+	T *m_huNetUpdatesRight;
+
+	/** Number of cells in x and y direction (without ghost cells) */
+	const unsigned int m_nx;
+	const unsigned int m_ny;
+	/** Size of one cell */
+	const T m_dx;
+	const T m_dy;
+
+	/** Columns and rows of one y-sweep tile */
+	unsigned int m_tileWidth;
+	unsigned int m_tileHeight;
+
+	/** Mean absolute rate of change of the unknowns in the last update */
+	T m_residual;
+
+	/** Fraction of the largest stable time step that is used */
+	T m_cflNumber;
+
+	/** Maximum wave speed (x and y) and residual of each thread */
+	tools::ThreadValues<T> m_threadMax;
+	tools::ThreadValues<T> m_threadMaxY;
+	tools::ThreadValues<T> m_threadResidual;
+
+	WavePropagation::Kernel m_kernel;
+
+public:
+	/**
+	 * @param h water heights, (nx + 2) * (ny + 2), row by row
+	 * @param hu momentums in x direction, same layout
+	 * @param hv momentums in y direction, same layout
+	 * @param b bathymetry, same layout
+	 * @param nx number of cells in x direction
+	 * @param ny number of cells in y direction
+	 * @param dx cell size in x direction
+	 * @param dy cell size in y direction
+	 */
+	WavePropagation2D(T *h, T *hu, T *hv, T *b, unsigned int nx, unsigned int ny, T dx, T dy)
+		: m_h(h), m_hu(hu), m_hv(hv), m_b(b),
+		  m_nx(nx), m_ny(ny), m_dx(dx), m_dy(dy),
+		  m_tileWidth(32), m_tileHeight(64),
+		  m_residual(0), m_cflNumber(0.4),
+		  m_kernel(WavePropagation::KernelFWave)
+	{
+		m_hNetUpdatesLeft = new T[(nx+1)*ny];
+		m_hNetUpdatesRight = new T[(nx+1)*ny];
+		m_huNetUpdatesLeft = new T[(nx+1)*ny];
+		m_huNetUpdatesRight = new T[(nx+1)*ny];
+	}
+
+	~WavePropagation2D()
+	{
+		delete [] m_hNetUpdatesLeft;
+		delete [] m_hNetUpdatesRight;
+		delete [] m_huNetUpdatesLeft;
+		delete [] m_huNetUpdatesRight;
+	}
+
+	/**
+	 * Select the solver for the net updates (default: KernelFWave)
+	 */
+	void setKernel(WavePropagation::Kernel kernel)
+	{
+		m_kernel = kernel;
+	}
+
+	WavePropagation::Kernel getKernel() const
+	{
+		return m_kernel;
+	}
+
+	/**
+	 * Set the CFL number (default: 0.4). Each sweep is stable up to 1.
+	 */
+	void setCflNumber(T cflNumber)
+	{
+		m_cflNumber = cflNumber;
+	}
+
+	T getCflNumber() const
+	{
+		return m_cflNumber;
+	}
+
+	/**
+	 * Size of the tiles in the y-sweep. The buffers of one tile should fit
+	 * into the L1/L2 cache (about 7 * width * height values).
+	 *
+	 * @param width number of columns, a multiple of the cache line size
+	 *  (in values) works best. With 1, the columns are gathered one by one.
+	 * @param height number of rows
+	 */
+	void setTileSize(unsigned int width, unsigned int height)
+	{
+		m_tileWidth = std::max(width, 1u);
+		m_tileHeight = std::max(height, 1u);
+	}
+
+	/**
+	 * Computes the net updates of the x-sweep and bounds the wave speeds
+	 * of the y-sweep in the same pass over the rows.
+	 *
+	 * @return Maximum allowed time step (CFL condition in x and y)
+	 */
+	T computeNumericalFluxes()
+	{
+		{
+			INSTR_PHASE(EdgeSolve);
+			TRACE_SCOPE("x_sweep");
+
+			m_threadMax.reset(0);
+			m_threadMaxY.reset(0);
+
+#ifdef _OPENMP
+			#pragma omp parallel
+#endif
+			{
+				{
+					TRACE_SCOPE("x_chunk");
+
+					solver::FWave<T> fwave;
+					solver::Hybrid<T> hybrid;
+					T maxWaveSpeed = 0;
+					T maxWaveSpeedY = 0;
+
+#ifdef _OPENMP
+					#pragma omp for schedule(static) nowait
+#endif
+					for (unsigned int j = 1; j < m_ny+1; j++) {
+						unsigned int row = j*(m_nx+2);
+						unsigned int edges = (j-1)*(m_nx+1);
+
+						T waveSpeed;
+						if (m_kernel == WavePropagation::KernelHybrid)
+							waveSpeed = hybrid.computeNetUpdates(m_h+row, m_hu+row, m_b+row, m_nx+1,
+								m_hNetUpdatesLeft+edges, m_hNetUpdatesRight+edges,
+								m_huNetUpdatesLeft+edges, m_huNetUpdatesRight+edges);
+						else
+							waveSpeed = fwave.computeNetUpdates(m_h+row, m_hu+row, m_b+row, m_nx+1,
+								m_hNetUpdatesLeft+edges, m_hNetUpdatesRight+edges,
+								m_huNetUpdatesLeft+edges, m_huNetUpdatesRight+edges);
+						maxWaveSpeed = std::max(maxWaveSpeed, waveSpeed);
+
+						// y edges above the row (and below the first row)
+						if (j == 1) {
+							for (unsigned int i = 1; i < m_nx+1; i++)
+								maxWaveSpeedY = std::max(maxWaveSpeedY, waveSpeedBoundY(i, row+i));
+						}
+						for (unsigned int i = 1; i < m_nx+1; i++)
+							maxWaveSpeedY = std::max(maxWaveSpeedY, waveSpeedBoundY(row+i, row+m_nx+2+i));
+					}
+
+					m_threadMax.set(maxWaveSpeed);
+					m_threadMaxY.set(maxWaveSpeedY);
+				}
+
+				TRACE_BARRIER();
+			}
+		}
+
+		INSTR_PHASE(Reduction);
+		T maxWaveSpeed = m_threadMax.max();
+		T maxWaveSpeedY = m_threadMaxY.max();
+
+		T dt = m_dx / maxWaveSpeed;
+		if (maxWaveSpeedY > 0)
+			dt = std::min(dt, m_dy / maxWaveSpeedY);
+		return dt * m_cflNumber;
+	}
+
+	/**
+	 * Updates the unknowns with the net updates of the x-sweep and runs
+	 * the y-sweep with the same time step.
+	 *
+	 * @param dt time step
+	 */
+	void updateUnknowns(T dt)
+	{
+		T residualX = updateX(dt);
+
+		// The y-sweep needs the ghost rows of the updated values
+		setOutflowBoundaryConditionsY();
+
+		T residualY = sweepY(dt);
+
+		m_residual = (residualX / m_dx + residualY / m_dy) / (m_nx * m_ny);
+	}
+
+	/**
+	 * Sets outflow boundary conditions in the ghost cells on all four sides
+	 */
+	void setOutflowBoundaryConditions()
+	{
+		INSTR_PHASE(Boundary);
+		TRACE_SCOPE("boundary");
+
+		for (unsigned int j = 1; j < m_ny+1; j++) {
+			unsigned int row = j*(m_nx+2);
+			m_h[row] = m_h[row+1]; m_h[row+m_nx+1] = m_h[row+m_nx];
+			m_hu[row] = m_hu[row+1]; m_hu[row+m_nx+1] = m_hu[row+m_nx];
+			m_hv[row] = m_hv[row+1]; m_hv[row+m_nx+1] = m_hv[row+m_nx];
+			m_b[row] = m_b[row+1]; m_b[row+m_nx+1] = m_b[row+m_nx];
+		}
+
+		setOutflowBoundaryConditionsY();
+	}
+
+	/**
+	 * @return Mean of the absolute rates of change of h, hu and hv over all
+	 *  cells in the last update. Goes to zero when the flow becomes steady.
+	 */
+	T getResidual() const
+	{
+		return m_residual;
+	}
+
+	/**
+	 * @return Water heights, (nx + 2) * (ny + 2) (incl. ghost cells)
+	 */
+	const T* getHeight() const
+	{
+		return m_h;
+	}
+
+	/**
+	 * @return Momentums in x direction
+	 */
+	const T* getMomentumX() const
+	{
+		return m_hu;
+	}
+
+	/**
+	 * @return Momentums in y direction
+	 */
+	const T* getMomentumY() const
+	{
+		return m_hv;
+	}
+
+	/**
+	 * @return Bathymetry
+	 */
+	const T* getBathymetry() const
+	{
+		return m_b;
+	}
+
+	unsigned int getSizeX() const
+	{
+		return m_nx;
+	}
+
+	unsigned int getSizeY() const
+	{
+		return m_ny;
+	}
+
+private:
+	/**
+	 * Applies the net updates of the x-sweep
+	 *
+	 * @return Sum of the absolute net updates
+	 */
+	T updateX(T dt)
+	{
+		{
+			INSTR_PHASE(CellUpdate);
+			TRACE_SCOPE("x_update");
+
+			m_threadResidual.reset(0);
+
+#ifdef _OPENMP
+			#pragma omp parallel
+#endif
+			{
+				{
+					TRACE_SCOPE("x_update_chunk");
+
+					T residual = 0;
+
+#ifdef _OPENMP
+					#pragma omp for schedule(static) nowait
+#endif
+					for (unsigned int j = 1; j < m_ny+1; j++) {
+						T *h = m_h + j*(m_nx+2);
+						T *hu = m_hu + j*(m_nx+2);
+						unsigned int edges = (j-1)*(m_nx+1);
+
+						for (unsigned int i = 1; i < m_nx+1; i++) {
+							T dh = m_hNetUpdatesRight[edges+i-1] + m_hNetUpdatesLeft[edges+i];
+							T dhu = m_huNetUpdatesRight[edges+i-1] + m_huNetUpdatesLeft[edges+i];
+
+							h[i] -= dt/m_dx * dh;
+							hu[i] -= dt/m_dx * dhu;
+
+							residual += std::fabs(dh) + std::fabs(dhu);
+						}
+					}
+
+					m_threadResidual.set(residual);
+				}
+
+				TRACE_BARRIER();
+			}
+		}
+
+		INSTR_PHASE(Reduction);
+		return m_threadResidual.sum();
+	}
+
+	/**
+	 * Computes the net updates in y direction and applies them.
+	 *
+	 * Each thread takes strips of m_tileWidth columns and walks up the
+	 * strip in tiles of m_tileHeight rows. A tile is transposed into
+	 * column-major buffers together with one row below and above, solved
+	 * with the batched kernel and written back. The (not yet updated) top
+	 * row of a tile is kept as the bottom row of the next tile.
+	 *
+	 * @return Sum of the absolute net updates
+	 */
+	T sweepY(T dt)
+	{
+		{
+			INSTR_PHASE(EdgeSolve);
+			TRACE_SCOPE("y_sweep");
+
+			const unsigned int numStrips = (m_nx + m_tileWidth - 1) / m_tileWidth;
+			// Leading dimension of the cell and the edge buffers
+			const unsigned int ldCells = m_tileHeight + 2;
+			const unsigned int ldEdges = m_tileHeight + 1;
+
+			m_threadResidual.reset(0);
+
+#ifdef _OPENMP
+			#pragma omp parallel
+#endif
+			{
+				{
+					TRACE_SCOPE("y_chunk");
+
+					solver::FWave<T> fwave;
+					solver::Hybrid<T> hybrid;
+
+					std::vector<T> h(m_tileWidth * ldCells);
+					std::vector<T> hv(m_tileWidth * ldCells);
+					std::vector<T> b(m_tileWidth * ldCells);
+					std::vector<T> hNetUpdatesLeft(m_tileWidth * ldEdges);
+					std::vector<T> hNetUpdatesRight(m_tileWidth * ldEdges);
+					std::vector<T> hvNetUpdatesLeft(m_tileWidth * ldEdges);
+					std::vector<T> hvNetUpdatesRight(m_tileWidth * ldEdges);
+					T residual = 0;
+
+#ifdef _OPENMP
+					#pragma omp for schedule(static) nowait
+#endif
+					for (unsigned int strip = 0; strip < numStrips; strip++) {
+						const unsigned int i0 = 1 + strip * m_tileWidth;
+						const unsigned int width = std::min(m_tileWidth, m_nx+1 - i0);
+
+						// Bottom ghost row
+						gatherRow(0, i0, width, &h[0], &hv[0], &b[0], ldCells, 0);
+
+						for (unsigned int j0 = 1; j0 < m_ny+1; j0 += m_tileHeight) {
+							const unsigned int height = std::min(m_tileHeight, m_ny+1 - j0);
+
+							// Rows j0 .. j0 + height (incl. the row above the tile)
+							for (unsigned int r = 1; r < height+2; r++)
+								gatherRow(j0-1+r, i0, width, &h[0], &hv[0], &b[0], ldCells, r);
+
+							for (unsigned int c = 0; c < width; c++) {
+								unsigned int cells = c*ldCells;
+								unsigned int edges = c*ldEdges;
+
+								// The time step is bounded by computeNumericalFluxes()
+								if (m_kernel == WavePropagation::KernelHybrid)
+									hybrid.computeNetUpdates(&h[cells], &hv[cells], &b[cells], height+1,
+										&hNetUpdatesLeft[edges], &hNetUpdatesRight[edges],
+										&hvNetUpdatesLeft[edges], &hvNetUpdatesRight[edges]);
+								else
+									fwave.computeNetUpdates(&h[cells], &hv[cells], &b[cells], height+1,
+										&hNetUpdatesLeft[edges], &hNetUpdatesRight[edges],
+										&hvNetUpdatesLeft[edges], &hvNetUpdatesRight[edges]);
+							}
+
+							for (unsigned int r = 1; r < height+1; r++) {
+								unsigned int cell = (j0-1+r)*(m_nx+2) + i0;
+
+								for (unsigned int c = 0; c < width; c++) {
+									unsigned int edge = c*ldEdges + r;
+									T dh = hNetUpdatesRight[edge-1] + hNetUpdatesLeft[edge];
+									T dhv = hvNetUpdatesRight[edge-1] + hvNetUpdatesLeft[edge];
+
+									m_h[cell+c] -= dt/m_dy * dh;
+									m_hv[cell+c] -= dt/m_dy * dhv;
+
+									residual += std::fabs(dh) + std::fabs(dhv);
+								}
+							}
+
+							// The old values of the top row are the bottom row of the next tile
+							for (unsigned int c = 0; c < width; c++) {
+								h[c*ldCells] = h[c*ldCells + height];
+								hv[c*ldCells] = hv[c*ldCells + height];
+								b[c*ldCells] = b[c*ldCells + height];
+							}
+						}
+					}
+
+					m_threadResidual.set(residual);
+				}
+
+				TRACE_BARRIER();
+			}
+		}
+
+		INSTR_PHASE(Reduction);
+		return m_threadResidual.sum();
+	}
+
+	/**
+	 * Upper bound of the wave speeds of both solvers at the y edge between
+	 * the cells a and b: the largest |v| plus sqrt(g * h) of the deeper
+	 * cell. Dry cells are reflected by the solvers, so only their depth
+	 * counts.
+	 */
+	T waveSpeedBoundY(unsigned int a, unsigned int b) const
+	{
+		const T dryTol = solver::FWave<T>::dryTol;
+
+		T v = 0;
+		if (m_h[a] >= dryTol)
+			v = std::fabs(m_hv[a] / m_h[a]);
+		if (m_h[b] >= dryTol)
+			v = std::max(v, std::fabs(m_hv[b] / m_h[b]));
+
+		return v + std::sqrt(solver::FWave<T>::g * std::max(m_h[a], m_h[b]));
+	}
+
+	/**
+	 * Copies width cells of row j, starting at column i0, into row r of
+	 * column-major buffers
+	 */
+	void gatherRow(unsigned int j, unsigned int i0, unsigned int width,
+			T *h, T *hv, T *b, unsigned int ld, unsigned int r) const
+	{
+		unsigned int cell = j*(m_nx+2) + i0;
+		for (unsigned int c = 0; c < width; c++) {
+			h[c*ld + r] = m_h[cell+c];
+			hv[c*ld + r] = m_hv[cell+c];
+			b[c*ld + r] = m_b[cell+c];
+		}
+	}
+
+	/**
+	 * Sets outflow boundary conditions in the bottom and top ghost rows
+	 */
+	void setOutflowBoundaryConditionsY()
+	{
+		const unsigned int rowSize = m_nx+2;
+		T* arrays[] = { m_h, m_hu, m_hv, m_b };
+
+		for (unsigned int k = 0; k < 4; k++) {
+			std::copy(arrays[k]+rowSize, arrays[k]+2*rowSize, arrays[k]);
+			std::copy(arrays[k]+m_ny*rowSize, arrays[k]+(m_ny+1)*rowSize, arrays[k]+(m_ny+1)*rowSize);
+		}
+	}
+
+	// Not copyable
+	WavePropagation2D(const WavePropagation2D&);
+	WavePropagation2D& operator=(const WavePropagation2D&);
+};
+
+#endif /* WAVEPROPAGATION2D_H_ */
@@ -0,0 +1,145 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Random edge states for the different flow regimes.
+ */
+
+#ifndef BENCHMARKS_EDGESTATES_H_
+#define BENCHMARKS_EDGESTATES_H_
+
+#include <cmath>
+#include <vector>
+
+#include "types.h"
+#include "solvers/FWave.hpp"
+
+namespace benchmarks
+{
+
+class EdgeStates
+{
+public:
+	enum Regime {
+		/** Both cells wet, |u| < sqrt(g*h) */
+		WetWetSubsonic,
+		/** Both cells wet, |u| > sqrt(g*h) (both wave speeds have the same sign) */
+		WetWetSupersonic,
+		/** Left cell wet, right cell dry */
+		WetDry,
+		/** Left cell dry, right cell wet */
+		DryWet,
+		/** Both cells dry */
+		DryDry
+	};
+
+	static const unsigned int numRegimes = 5;
+
+	std::vector<T> hl, hr, hul, hur, bl, br;
+
+private:
+	/** State of the random number generator */
+	unsigned int m_seed;
+
+public:
+	/**
+	 * @param regime flow regime of all edges
+	 * @param bathymetry use a random bathymetry instead of b = 0
+	 * @param size number of edges
+	 * @param seed seed for the random number generator
+	 */
+	EdgeStates(Regime regime, bool bathymetry, unsigned int size, unsigned int seed = 42)
+		: hl(size), hr(size), hul(size), hur(size), bl(size), br(size),
+		  m_seed(seed)
+	{
+		for (unsigned int i = 0; i < size; i++) {
+			switch (regime) {
+			case WetWetSubsonic:
+				hl[i] = random(1, 10);
+				hr[i] = random(1, 10);
+				hul[i] = hl[i] * random(-1, 1);
+				hur[i] = hr[i] * random(-1, 1);
+				break;
+			case WetWetSupersonic:
+				{
+					// Random direction, same for both cells
+					T dir = random(-1, 1) < 0 ? -1 : 1;
+					hl[i] = random(0.1, 1);
+					hr[i] = random(0.1, 1);
+					hul[i] = dir * hl[i] * random(8, 12);
+					hur[i] = dir * hr[i] * random(8, 12);
+				}
+				break;
+			case WetDry:
+				hl[i] = random(1, 10);
+				hr[i] = dry();
+				hul[i] = hl[i] * random(-1, 1);
+				hur[i] = 0;
+				break;
+			case DryWet:
+				hl[i] = dry();
+				hr[i] = random(1, 10);
+				hul[i] = 0;
+				hur[i] = hr[i] * random(-1, 1);
+				break;
+			case DryDry:
+				hl[i] = dry();
+				hr[i] = dry();
+				hul[i] = hur[i] = 0;
+				break;
+			}
+
+			if (bathymetry) {
+				bl[i] = random(-10, 0);
+				br[i] = bl[i] + random(-0.5, 0.5);
+			} else {
+				bl[i] = br[i] = 0;
+			}
+		}
+	}
+
+	unsigned int size() const
+	{
+		return hl.size();
+	}
+
+	static const char* name(Regime regime)
+	{
+		switch (regime) {
+		case WetWetSubsonic:
+			return "wetwet_subsonic";
+		case WetWetSupersonic:
+			return "wetwet_supersonic";
+		case WetDry:
+			return "wetdry";
+		case DryWet:
+			return "drywet";
+		case DryDry:
+			return "drydry";
+		}
+		return "unknown";
+	}
+
+private:
+	/**
+	 * @return Uniform random number in [min, max)
+	 */
+	T random(double min, double max)
+	{
+		// Numerical Recipes LCG, reproducible on all platforms
+		m_seed = 1664525u * m_seed + 1013904223u;
+		return static_cast<T>(min + (max - min) * (m_seed >> 8) / 16777216.);
+	}
+
+	/**
+	 * @return Height of a dry cell (above the zero tolerance of the solver)
+	 */
+	static T dry()
+	{
+		return solver::FWave<T>::dryTol * (T)0.5;
+	}
+};
+
+}
+
+#endif /* BENCHMARKS_EDGESTATES_H_ */
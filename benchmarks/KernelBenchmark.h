@@ -0,0 +1,71 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Edge throughput of the net update kernels.
+ */
+
+#ifndef BENCHMARKS_KERNELBENCHMARK_H_
+#define BENCHMARKS_KERNELBENCHMARK_H_
+
+#include "types.h"
+#include "benchmarks/EdgeStates.h"
+#include "benchmarks/PerfCounters.h"
+#include "benchmarks/Result.h"
+#include "tools/Timer.h"
+
+namespace benchmarks
+{
+
+/**
+ * Calls Solver::computeNetUpdates on all edges of the given states
+ *
+ * @param name name of the kernel variant
+ * @param solver the solver
+ * @param states edge states (see EdgeStates)
+ * @param perf hardware counters, read around the measurement
+ * @param minSeconds the edges are processed repeatedly for at least this time
+ */
+template<class Solver>
+Result benchmarkKernel(const char* name, Solver &solver, const EdgeStates &states,
+		PerfCounters &perf, double minSeconds = 0.2)
+{
+	const unsigned int size = states.size();
+
+	// Keeps the compiler from removing the kernel calls
+	T sink = 0;
+
+	Result result;
+	result.name = name;
+	// Six input values per edge
+	result.bytesPerItem = 6 * sizeof(T);
+
+	perf.start();
+	double start = tools::Timer::now();
+	uint64_t startCycles = tools::Timer::cycles();
+
+	do {
+		for (unsigned int i = 0; i < size; i++) {
+			T hl, hr, hul, hur, maxWS;
+			solver.computeNetUpdates(states.hl[i], states.hr[i], states.hul[i], states.hur[i],
+				states.bl[i], states.br[i], hl, hr, hul, hur, maxWS);
+			sink += hl + hr + hul + hur + maxWS;
+		}
+		result.items += size;
+		result.seconds = tools::Timer::now() - start;
+	} while (result.seconds < minSeconds);
+
+	result.cycles = tools::Timer::cycles() - startCycles;
+	perf.stop();
+	result.setCounters(perf);
+
+	// Never true, but the compiler can not know that
+	if (sink == (T)-1.2345)
+		result.items++;
+
+	return result;
+}
+
+}
+
+#endif /* BENCHMARKS_KERNELBENCHMARK_H_ */
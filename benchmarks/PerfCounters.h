@@ -0,0 +1,194 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Hardware performance counters via perf_event_open (Linux only).
+ *
+ *  Counters that can not be opened (other OS, missing permissions, see
+ *  /proc/sys/kernel/perf_event_paranoid, or not supported by the CPU) are
+ *  silently skipped and reported as unavailable.
+ *
+ *  The counters include all threads that are created after the
+ *  constructor (inherited counters), so create PerfCounters before the
+ *  first OpenMP parallel region. The OpenMP threads are created once and
+ *  reused, threads that already exist are not counted.
+ *
+ *  There is no generic event for floating point operations. Set
+ *  SWE1D_PERF_FP_EVENT to a raw event config (hex, e.g. "0x10c7" for
+ *  FP_ARITH_INST_RETIRED.SCALAR_SINGLE on Intel) to count them.
+ */
+
+#ifndef BENCHMARKS_PERFCOUNTERS_H_
+#define BENCHMARKS_PERFCOUNTERS_H_
+
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace benchmarks
+{
+
+class PerfCounters
+{
+public:
+	enum Event {
+		Cycles,
+		Instructions,
+		BranchMisses,
+		/** Last level cache misses */
+		CacheMisses,
+		/** Floating point operations (raw event, see SWE1D_PERF_FP_EVENT) */
+		FPOps,
+		NumEvents
+	};
+
+private:
+	/** File descriptors, -1 if not available */
+	int m_fd[NumEvents];
+
+	/** Counter values of the last measurement */
+	uint64_t m_values[NumEvents];
+
+public:
+	PerfCounters()
+	{
+		for (unsigned int i = 0; i < NumEvents; i++) {
+			m_fd[i] = -1;
+			m_values[i] = 0;
+		}
+
+#ifdef __linux__
+		m_fd[Cycles] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+		m_fd[Instructions] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+		m_fd[BranchMisses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+		m_fd[CacheMisses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+
+		const char* fpEvent = getenv("SWE1D_PERF_FP_EVENT");
+		if (fpEvent)
+			m_fd[FPOps] = open(PERF_TYPE_RAW, strtoull(fpEvent, 0L, 16));
+#endif
+	}
+
+	~PerfCounters()
+	{
+#ifdef __linux__
+		for (unsigned int i = 0; i < NumEvents; i++) {
+			if (m_fd[i] >= 0)
+				close(m_fd[i]);
+		}
+#endif
+	}
+
+	/**
+	 * Reset and start all available counters
+	 */
+	void start()
+	{
+#ifdef __linux__
+		for (unsigned int i = 0; i < NumEvents; i++) {
+			if (m_fd[i] >= 0) {
+				ioctl(m_fd[i], PERF_EVENT_IOC_RESET, 0);
+				ioctl(m_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+#endif
+	}
+
+	/**
+	 * Stop all counters and read the values
+	 */
+	void stop()
+	{
+#ifdef __linux__
+		for (unsigned int i = 0; i < NumEvents; i++) {
+			if (m_fd[i] >= 0)
+				ioctl(m_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+		}
+
+		for (unsigned int i = 0; i < NumEvents; i++) {
+			if (m_fd[i] < 0)
+				continue;
+
+			// Value, time enabled, time running
+			uint64_t data[3];
+			if (read(m_fd[i], data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+				m_values[i] = 0;
+				continue;
+			}
+
+			// Scale if the counter was multiplexed
+			m_values[i] = data[2] < data[1]
+				? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+				: data[0];
+		}
+#endif
+	}
+
+	bool available(Event event) const
+	{
+		return m_fd[event] >= 0;
+	}
+
+	/**
+	 * @return True if at least one counter is available
+	 */
+	bool anyAvailable() const
+	{
+		for (unsigned int i = 0; i < NumEvents; i++) {
+			if (m_fd[i] >= 0)
+				return true;
+		}
+		return false;
+	}
+
+	/**
+	 * @return Value of the last measurement
+	 */
+	uint64_t value(Event event) const
+	{
+		return m_values[event];
+	}
+
+	static const char* name(Event event)
+	{
+		static const char* names[NumEvents] = {
+			"cycles", "instructions", "branch_misses", "llc_misses", "fp_ops"
+		};
+		return names[event];
+	}
+
+private:
+#ifdef __linux__
+	/**
+	 * @return File descriptor of the counter or -1 on error
+	 */
+	static int open(uint32_t type, uint64_t config)
+	{
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		// Count the threads created later (OpenMP) as well. Reading and
+		// the ioctls cover the counters of these threads.
+		attr.inherit = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	}
+#endif
+};
+
+}
+
+#endif /* BENCHMARKS_PERFCOUNTERS_H_ */
@@ -0,0 +1,132 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Result of a single benchmark and its JSON output.
+ */
+
+#ifndef BENCHMARKS_RESULT_H_
+#define BENCHMARKS_RESULT_H_
+
+#include <ostream>
+#include <string>
+#include <stdint.h>
+
+#include "benchmarks/PerfCounters.h"
+#include "tools/Timer.h"
+
+namespace benchmarks
+{
+
+struct Result
+{
+	/** Kernel variant or scenario name */
+	std::string name;
+	/** Flow regime (kernel benchmarks only) */
+	std::string regime;
+	/** Kernel variant (scenario benchmarks only) */
+	std::string kernel;
+	bool bathymetry;
+
+	/** Number of edges (kernel) or cell updates (scenario) processed */
+	uint64_t items;
+	/** Wall clock time in seconds */
+	double seconds;
+	/** Time stamp counter cycles */
+	uint64_t cycles;
+
+	/** Initialization time in seconds (scenario benchmarks only) */
+	double initSeconds;
+
+	/** Minimum number of bytes transferred per item */
+	unsigned int bytesPerItem;
+
+	/** Hardware counters */
+	bool counterAvailable[PerfCounters::NumEvents];
+	uint64_t counters[PerfCounters::NumEvents];
+
+	Result()
+		: bathymetry(false), items(0), seconds(0), cycles(0), initSeconds(0), bytesPerItem(0)
+	{
+		for (unsigned int i = 0; i < PerfCounters::NumEvents; i++) {
+			counterAvailable[i] = false;
+			counters[i] = 0;
+		}
+	}
+
+	/**
+	 * Copy the values of the last measurement
+	 */
+	void setCounters(const PerfCounters &perf)
+	{
+		for (unsigned int i = 0; i < PerfCounters::NumEvents; i++) {
+			PerfCounters::Event event = static_cast<PerfCounters::Event>(i);
+			counterAvailable[i] = perf.available(event);
+			counters[i] = perf.value(event);
+		}
+	}
+
+	/**
+	 * Write the result as JSON object
+	 *
+	 * @param itemName name of a processed item, e.g. "edge" or "cell"
+	 */
+	void writeJson(std::ostream &out, const char* itemName) const
+	{
+		out << "{\"name\": \"" << name << '"';
+		if (!regime.empty())
+			out << ", \"regime\": \"" << regime << '"';
+		if (!kernel.empty())
+			out << ", \"kernel\": \"" << kernel << '"';
+		out << ", \"bathymetry\": " << (bathymetry ? "true" : "false")
+			<< ", \"" << itemName << "s\": " << items
+			<< ", \"seconds\": " << seconds
+			<< ", \"" << itemName << "s_per_second\": " << items / seconds;
+		if (tools::Timer::haveCycles())
+			out << ", \"cycles_per_" << itemName << "\": "
+				<< static_cast<double>(cycles) / items;
+		if (initSeconds > 0)
+			out << ", \"init_seconds\": " << initSeconds;
+		if (bytesPerItem)
+			out << ", \"bandwidth_gbs\": " << items * bytesPerItem / seconds * 1e-9;
+
+		// Hardware counters, only the available ones
+		out << ", \"counters\": {";
+		bool first = true;
+		for (unsigned int i = 0; i < PerfCounters::NumEvents; i++) {
+			if (!counterAvailable[i])
+				continue;
+			out << (first ? "\"" : ", \"") << PerfCounters::name(static_cast<PerfCounters::Event>(i))
+				<< "\": " << counters[i];
+			first = false;
+		}
+		out << '}';
+
+		if (counterAvailable[PerfCounters::Cycles] && counterAvailable[PerfCounters::Instructions]
+				&& counters[PerfCounters::Cycles])
+			out << ", \"ipc\": " << static_cast<double>(counters[PerfCounters::Instructions])
+				/ counters[PerfCounters::Cycles];
+		if (counterAvailable[PerfCounters::Cycles])
+			out << ", \"core_cycles_per_" << itemName << "\": "
+				<< static_cast<double>(counters[PerfCounters::Cycles]) / items;
+		if (counterAvailable[PerfCounters::BranchMisses])
+			out << ", \"branch_misses_per_" << itemName << "\": "
+				<< static_cast<double>(counters[PerfCounters::BranchMisses]) / items;
+		if (counterAvailable[PerfCounters::CacheMisses]) {
+			out << ", \"llc_misses_per_" << itemName << "\": "
+				<< static_cast<double>(counters[PerfCounters::CacheMisses]) / items;
+			// Each miss transfers one cache line from memory
+			out << ", \"memory_bandwidth_gbs\": "
+				<< counters[PerfCounters::CacheMisses] * 64. / seconds * 1e-9;
+		}
+		if (counterAvailable[PerfCounters::FPOps])
+			out << ", \"fp_ops_per_" << itemName << "\": "
+				<< static_cast<double>(counters[PerfCounters::FPOps]) / items;
+
+		out << '}';
+	}
+};
+
+}
+
+#endif /* BENCHMARKS_RESULT_H_ */
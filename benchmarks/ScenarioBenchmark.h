@@ -0,0 +1,86 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  End-to-end throughput of the scenarios.
+ */
+
+#ifndef BENCHMARKS_SCENARIOBENCHMARK_H_
+#define BENCHMARKS_SCENARIOBENCHMARK_H_
+
+#include "types.h"
+#include "Scenario.h"
+#include "WavePropagation.h"
+#include "dambreak.h"
+#include "rarerare.h"
+#include "shockshock.h"
+#include "SubCriticalFlow.h"
+#include "SuperCriticalFlow.h"
+#include "benchmarks/PerfCounters.h"
+#include "benchmarks/Result.h"
+#include "tools/Arena.h"
+#include "tools/Timer.h"
+
+namespace benchmarks
+{
+
+/**
+ * Runs the complete time step (boundary conditions, net updates, cell updates)
+ *
+ * @param name name of the scenario
+ * @param scenario the scenario
+ * @param size number of cells
+ * @param kernel solver used for the net updates
+ * @param perf hardware counters, read around the measurement
+ * @param reproducible see WavePropagation::setReproducible()
+ * @param minSeconds time steps are computed for at least this time
+ */
+template<class Scenario>
+Result benchmarkScenario(const char* name, Scenario &scenario, unsigned int size,
+		WavePropagation::Kernel kernel, PerfCounters &perf, bool reproducible = false,
+		double minSeconds = 0.5)
+{
+	Result result;
+
+	double initStart = tools::Timer::now();
+	tools::Arena arena(3 * tools::Arena::bytes<T>(size+2) + WavePropagation::arenaBytes(size));
+	T *h = arena.allocate<T>(size+2);
+	T *hu = arena.allocate<T>(size+2);
+	T *b = arena.allocate<T>(size+2);
+	scenarios::init(scenario, h, hu, b, size);
+	result.initSeconds = tools::Timer::now() - initStart;
+
+	WavePropagation wavePropagation(h, hu, b, size, scenario.getCellSize(), arena);
+	wavePropagation.setKernel(kernel);
+	wavePropagation.setReproducible(reproducible);
+
+	result.name = name;
+	// Edge sweep: read h, hu, b, write 4 net updates
+	// Cell update: read 4 net updates, read and write h, hu
+	result.bytesPerItem = 15 * sizeof(T);
+	for (unsigned int i = 1; i < size+1; i++)
+		result.bathymetry |= (b[i] != 0);
+
+	perf.start();
+	double start = tools::Timer::now();
+	uint64_t startCycles = tools::Timer::cycles();
+
+	do {
+		wavePropagation.setOutflowBoundaryConditions();
+		T dt = wavePropagation.computeNumericalFluxes();
+		wavePropagation.updateUnknowns(dt);
+
+		result.items += size;
+		result.seconds = tools::Timer::now() - start;
+	} while (result.seconds < minSeconds);
+
+	result.cycles = tools::Timer::cycles() - startCycles;
+	perf.stop();
+	result.setCounters(perf);
+
+	return result;
+}
+
+}
+
+#endif /* BENCHMARKS_SCENARIOBENCHMARK_H_ */
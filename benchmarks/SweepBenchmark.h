@@ -0,0 +1,83 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Throughput of the 2D engine (x- and y-sweep) for different tile sizes.
+ */
+
+#ifndef BENCHMARKS_SWEEPBENCHMARK_H_
+#define BENCHMARKS_SWEEPBENCHMARK_H_
+
+#include <vector>
+
+#include "types.h"
+#include "WavePropagation.h"
+#include "WavePropagation2D.h"
+#include "benchmarks/PerfCounters.h"
+#include "benchmarks/Result.h"
+#include "tools/Timer.h"
+
+namespace benchmarks
+{
+
+/**
+ * Runs complete 2D time steps of a radial dam break
+ *
+ * @param name name of the configuration
+ * @param n number of cells in x and y direction
+ * @param tileWidth see WavePropagation2D::setTileSize()
+ * @param tileHeight see WavePropagation2D::setTileSize()
+ * @param perf hardware counters, read around the measurement
+ * @param minSeconds time steps are computed for at least this time
+ */
+inline Result benchmarkSweeps2D(const char* name, unsigned int n,
+		unsigned int tileWidth, unsigned int tileHeight,
+		PerfCounters &perf, double minSeconds = 0.5)
+{
+	Result result;
+
+	const T cellSize = 1000.f / n;
+
+	double initStart = tools::Timer::now();
+	std::vector<T> h((n+2)*(n+2)), hu((n+2)*(n+2)), hv((n+2)*(n+2)), b((n+2)*(n+2));
+	for (unsigned int j = 0; j < n+2; j++) {
+		for (unsigned int i = 0; i < n+2; i++) {
+			T x = (i + 0.5f) * cellSize - 500;
+			T y = (j + 0.5f) * cellSize - 500;
+			h[j*(n+2)+i] = (x*x + y*y < 100*100) ? 14 : 3.5f;
+		}
+	}
+	result.initSeconds = tools::Timer::now() - initStart;
+
+	WavePropagation2D wavePropagation(&h[0], &hu[0], &hv[0], &b[0], n, n, cellSize, cellSize);
+	wavePropagation.setTileSize(tileWidth, tileHeight);
+
+	result.name = name;
+	result.kernel = "fwave";
+	// Each sweep: read h, hu/hv, b, write h, hu/hv (net updates of the
+	// x-sweep: write 4, read 4)
+	result.bytesPerItem = 18 * sizeof(T);
+
+	perf.start();
+	double start = tools::Timer::now();
+	uint64_t startCycles = tools::Timer::cycles();
+
+	do {
+		wavePropagation.setOutflowBoundaryConditions();
+		T dt = wavePropagation.computeNumericalFluxes();
+		wavePropagation.updateUnknowns(dt);
+
+		result.items += static_cast<uint64_t>(n) * n;
+		result.seconds = tools::Timer::now() - start;
+	} while (result.seconds < minSeconds);
+
+	result.cycles = tools::Timer::cycles() - startCycles;
+	perf.stop();
+	result.setCounters(perf);
+
+	return result;
+}
+
+}
+
+#endif /* BENCHMARKS_SWEEPBENCHMARK_H_ */
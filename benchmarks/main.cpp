@@ -0,0 +1,135 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Benchmarks for the net update kernels and the scenarios. The results
+ *  are written as JSON to stdout.
+ *
+ *  Build (from the repository root, with types.h in the include path):
+ *  <code>g++ -std=c++11 -O3 -fopenmp -DNDEBUG -I. benchmarks/main.cpp -o benchmark</code>
+ *
+ *  Usage: <code>benchmark [edges] [cells] [cells2d]</code>
+ *  (cells2d: cells in each direction of the 2D benchmarks)
+ *
+ *  Hardware counters are included if available (see PerfCounters).
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+#include "types.h"
+#include "solvers/FWave.hpp"
+#include "solvers/Hybrid.hpp"
+#include "benchmarks/EdgeStates.h"
+#include "benchmarks/KernelBenchmark.h"
+#include "benchmarks/PerfCounters.h"
+#include "benchmarks/ScenarioBenchmark.h"
+#include "benchmarks/SweepBenchmark.h"
+
+using namespace benchmarks;
+
+int main(int argc, char** argv)
+{
+	unsigned int numEdges = 1 << 16;
+	unsigned int numCells = 1 << 16;
+	if (argc > 1)
+		numEdges = atoi(argv[1]);
+	if (argc > 2)
+		numCells = atoi(argv[2]);
+	unsigned int numCells2D = 2048;
+	if (argc > 3)
+		numCells2D = atoi(argv[3]);
+
+	// Before the first parallel region, so the counters include the
+	// OpenMP threads
+	PerfCounters perf;
+
+	std::cout << "{\n\"perf_counters\": " << (perf.anyAvailable() ? "true" : "false")
+		<< ",\n\"kernels\": [";
+
+	bool first = true;
+	for (unsigned int r = 0; r < EdgeStates::numRegimes; r++) {
+		for (int bathymetry = 0; bathymetry < 2; bathymetry++) {
+			EdgeStates::Regime regime = static_cast<EdgeStates::Regime>(r);
+			EdgeStates states(regime, bathymetry, numEdges);
+
+			// All kernel variants
+			solver::FWave<T> fwave;
+			solver::Hybrid<T> hybrid;
+			Result results[] = {
+				benchmarkKernel("fwave", fwave, states, perf),
+				benchmarkKernel("hybrid", hybrid, states, perf)
+			};
+
+			for (unsigned int i = 0; i < sizeof(results)/sizeof(Result); i++) {
+				results[i].regime = EdgeStates::name(regime);
+				results[i].bathymetry = bathymetry;
+
+				std::cout << (first ? "\n  " : ",\n  ");
+				results[i].writeJson(std::cout, "edge");
+				first = false;
+			}
+		}
+	}
+
+	std::cout << "\n],\n\"scenarios\": [";
+
+	scenarios::DamBreak damBreak(numCells);
+	scenarios::RareRare rareRare(numCells, 10);
+	scenarios::ShockShock shockShock(numCells, 10);
+	scenarios::SubCriticalFlow subCritical(numCells);
+	scenarios::SuperCriticalFlow superCritical(numCells);
+
+	const WavePropagation::Kernel kernels[] = {
+		WavePropagation::KernelFWave,
+		WavePropagation::KernelHybrid
+	};
+	const char* kernelNames[] = { "fwave", "hybrid" };
+
+	for (unsigned int k = 0; k < sizeof(kernels)/sizeof(kernels[0]); k++) {
+		Result results[] = {
+			benchmarkScenario("dambreak", damBreak, numCells, kernels[k], perf),
+			benchmarkScenario("rarerare", rareRare, numCells, kernels[k], perf),
+			benchmarkScenario("shockshock", shockShock, numCells, kernels[k], perf),
+			benchmarkScenario("subcritical", subCritical, numCells, kernels[k], perf),
+			benchmarkScenario("supercritical", superCritical, numCells, kernels[k], perf)
+		};
+
+		for (unsigned int i = 0; i < sizeof(results)/sizeof(Result); i++) {
+			results[i].kernel = kernelNames[k];
+
+			std::cout << (k == 0 && i == 0 ? "\n  " : ",\n  ");
+			results[i].writeJson(std::cout, "cell");
+		}
+	}
+
+	std::cout << "\n],\n\"reproducible\": [";
+
+	// Overhead of the fixed order sums
+	Result reproducibleResults[] = {
+		benchmarkScenario("free", damBreak, numCells, WavePropagation::KernelFWave, perf, false),
+		benchmarkScenario("reproducible", damBreak, numCells, WavePropagation::KernelFWave, perf, true)
+	};
+	for (unsigned int i = 0; i < sizeof(reproducibleResults)/sizeof(Result); i++) {
+		reproducibleResults[i].kernel = "fwave";
+
+		std::cout << (i == 0 ? "\n  " : ",\n  ");
+		reproducibleResults[i].writeJson(std::cout, "cell");
+	}
+
+	std::cout << "\n],\n\"sweeps2d\": [";
+
+	// Tiled y-sweep vs. gathering the columns one by one
+	Result sweepResults[] = {
+		benchmarkSweeps2D("tiled", numCells2D, 32, 64, perf),
+		benchmarkSweeps2D("strided", numCells2D, 1, 64, perf)
+	};
+	for (unsigned int i = 0; i < sizeof(sweepResults)/sizeof(Result); i++) {
+		std::cout << (i == 0 ? "\n  " : ",\n  ");
+		sweepResults[i].writeJson(std::cout, "cell");
+	}
+
+	std::cout << "\n]\n}" << std::endl;
+
+	return 0;
+}
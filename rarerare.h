@@ -84,6 +84,31 @@ public:
 
 
 
+	/**
+	 * @return Bathymetry at pos
+	 */
+	T getBathymetry(unsigned int)
+	{
+		return 0;
+	}
+
+	/**
+	 * Initial values of the cells [begin, end)
+	 *
+	 * @param h water heights of the cells from offset on (without ghost cells)
+	 * @param hu momentums of the cells from offset on
+	 * @param b bathymetry of the cells from offset on
+	 * @param offset global index of h[0], hu[0] and b[0]
+	 */
+	void fill(T *h, T *hu, T *b, unsigned int offset, unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++) {
+			h[i-offset] = getHeight(i);
+			hu[i-offset] = getVelocity(i);
+			b[i-offset] = getBathymetry(i);
+		}
+	}
+
 	/**
 	 * @return Cell size of one cell (= domain size/number of cells)
 	 */
@@ -0,0 +1,156 @@
+/*
+ * AdaptiveWavePropagationTest.h
+ *
+ *  Adaptive mesh refinement with two levels.
+ */
+
+#ifndef ADAPTIVEWAVEPROPAGATIONTEST_H_
+#define ADAPTIVEWAVEPROPAGATIONTEST_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../AdaptiveWavePropagation.h"
+#include "../Scenario.h"
+#include "../WavePropagation.h"
+#include "../dambreak.h"
+
+class AdaptiveWavePropagationTest : public CxxTest::TestSuite
+{
+private:
+	static const unsigned int size = 250;
+	static const unsigned int ratio = 4;
+
+	/** The waves do not reach the boundaries before */
+	static const T endTime;
+
+	std::vector<T> h, hu, b;
+
+	/**
+	 * Runs an engine up to endTime with outflow boundaries
+	 */
+	template<class Engine>
+	static void run(Engine &engine) {
+		for (T t = 0; t < endTime; ) {
+			engine.setOutflowBoundaryConditions();
+			T dt = std::min(engine.computeNumericalFluxes(), endTime - t);
+			engine.updateUnknowns(dt);
+			t += dt;
+		}
+	}
+
+	static double mass(const T *h, unsigned int size) {
+		double mass = 0;
+		for (unsigned int i = 1; i < size+1; i++)
+			mass += h[i];
+		return mass;
+	}
+
+public:
+	void setUp() {
+		scenarios::DamBreak scenario(size);
+		h.resize(size+2);
+		hu.resize(size+2);
+		b.resize(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+	}
+
+	/**
+	 * Only the blocks around the waves are refined
+	 */
+	void testRefinement(void) {
+		AdaptiveWavePropagation adaptive(&h[0], &hu[0], &b[0], size, 1000. / size, ratio, 10);
+
+		TS_ASSERT(adaptive.isRefined(size/2));
+		TS_ASSERT(!adaptive.isRefined(1));
+		TS_ASSERT(!adaptive.isRefined(size));
+		TS_ASSERT_LESS_THAN(adaptive.getActiveCells(), size * ratio / 2);
+
+		run(adaptive);
+		TS_ASSERT(!adaptive.isRefined(1));
+		TS_ASSERT(!adaptive.isRefined(size));
+	}
+
+	/**
+	 * Refluxing keeps the mass of the coarse cells, the fine cells and
+	 * the regrids up to round-off
+	 */
+	void testMass(void) {
+		AdaptiveWavePropagation adaptive(&h[0], &hu[0], &b[0], size, 1000. / size, ratio, 10);
+
+		double initialMass = mass(&h[0], size);
+		run(adaptive);
+
+		TS_ASSERT_DELTA(mass(&h[0], size), initialMass, initialMass * 1e-6);
+	}
+
+	/**
+	 * The solution is closer to the fine grid than a coarse grid with the
+	 * same number of cells
+	 */
+	void testError(void) {
+		const T cellSize = 1000. / size;
+
+		AdaptiveWavePropagation adaptive(&h[0], &hu[0], &b[0], size, cellSize, ratio, 10);
+		run(adaptive);
+
+		scenarios::DamBreak scenario(size);
+		std::vector<T> hCoarse(size+2), huCoarse(size+2), bCoarse(size+2);
+		scenarios::init(scenario, &hCoarse[0], &huCoarse[0], &bCoarse[0], size);
+		WavePropagation coarse(&hCoarse[0], &huCoarse[0], &bCoarse[0], size, cellSize);
+		run(coarse);
+
+		scenarios::DamBreak fineScenario(size * ratio);
+		std::vector<T> hFine(size*ratio+2), huFine(size*ratio+2), bFine(size*ratio+2);
+		scenarios::init(fineScenario, &hFine[0], &huFine[0], &bFine[0], size*ratio);
+		WavePropagation fine(&hFine[0], &huFine[0], &bFine[0], size*ratio, cellSize / ratio);
+		run(fine);
+
+		// L1 error against the averages of the fine grid
+		T adaptiveError = 0, coarseError = 0;
+		for (unsigned int i = 1; i < size+1; i++) {
+			T reference = 0;
+			for (unsigned int j = (i-1) * ratio + 1; j <= i * ratio; j++)
+				reference += hFine[j];
+			reference /= ratio;
+
+			adaptiveError += std::fabs(h[i] - reference);
+			coarseError += std::fabs(hCoarse[i] - reference);
+		}
+
+		TS_ASSERT_LESS_THAN(adaptiveError, coarseError * (T)0.75);
+	}
+
+	/**
+	 * setState() keeps the fine solution of the patches, so the
+	 * simulation continues bit for bit
+	 */
+	void testState(void) {
+		AdaptiveWavePropagation adaptive(&h[0], &hu[0], &b[0], size, 1000. / size, ratio, 10);
+		run(adaptive);
+
+		std::vector<T> state;
+		adaptive.getState(state);
+		const T *fineH = adaptive.getFineHeight();
+		std::vector<T> savedFine(fineH, fineH + size*ratio+2);
+
+		run(adaptive);
+		std::vector<T> first = h;
+		std::vector<T> firstFine(fineH, fineH + size*ratio+2);
+		unsigned int firstCells = adaptive.getActiveCells();
+
+		adaptive.setState(state);
+		TS_ASSERT(std::vector<T>(fineH, fineH + size*ratio+2) == savedFine);
+
+		run(adaptive);
+		TS_ASSERT(h == first);
+		TS_ASSERT(std::vector<T>(fineH, fineH + size*ratio+2) == firstFine);
+		TS_ASSERT_EQUALS(adaptive.getActiveCells(), firstCells);
+	}
+};
+
+const T AdaptiveWavePropagationTest::endTime = 15;
+
+#endif /* ADAPTIVEWAVEPROPAGATIONTEST_H_ */
@@ -0,0 +1,103 @@
+/*
+ * ArenaTest.h
+ *
+ *  Arena allocator for the arrays of a simulation.
+ */
+
+#ifndef ARENATEST_H_
+#define ARENATEST_H_
+
+#include <new>
+#include <stdint.h>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Scenario.h"
+#include "../WavePropagation.h"
+#include "../dambreak.h"
+#include "../tools/Arena.h"
+
+class ArenaTest : public CxxTest::TestSuite
+{
+private:
+	static const unsigned int size = 1000;
+
+public:
+	/**
+	 * All arrays are aligned and do not overlap
+	 */
+	void testAllocate(void) {
+		tools::Arena arena(3 * tools::Arena::bytes<T>(size+2) + tools::Arena::bytes<char>(1),
+			tools::Arena::NoHugePages);
+
+		T *h = arena.allocate<T>(size+2);
+		char *c = arena.allocate<char>(1);
+		T *hu = arena.allocate<T>(size+2);
+		T *b = arena.allocate<T>(size+2);
+
+		TS_ASSERT_EQUALS(reinterpret_cast<uintptr_t>(h) % tools::Arena::alignment, 0u);
+		TS_ASSERT_EQUALS(reinterpret_cast<uintptr_t>(c) % tools::Arena::alignment, 0u);
+		TS_ASSERT_EQUALS(reinterpret_cast<uintptr_t>(hu) % tools::Arena::alignment, 0u);
+		TS_ASSERT_EQUALS(reinterpret_cast<uintptr_t>(b) % tools::Arena::alignment, 0u);
+		TS_ASSERT(h + size+2 <= reinterpret_cast<T*>(c));
+		TS_ASSERT(c + 1 <= reinterpret_cast<char*>(hu));
+		TS_ASSERT(hu + size+2 <= b);
+
+		TS_ASSERT_EQUALS(arena.used(), arena.capacity());
+		TS_ASSERT_THROWS(arena.allocate<char>(1), std::bad_alloc);
+	}
+
+	/**
+	 * Huge pages round the capacity up to whole pages
+	 */
+	void testHugePages(void) {
+		tools::Arena arena(1, tools::Arena::TransparentHugePages);
+		TS_ASSERT_EQUALS(arena.capacity(), tools::Arena::hugePageSize);
+
+		// Falls back to transparent huge pages if none are reserved
+		tools::Arena explicitArena(tools::Arena::hugePageSize + 1, tools::Arena::ExplicitHugePages);
+		TS_ASSERT_EQUALS(explicitArena.capacity(), 2 * tools::Arena::hugePageSize);
+		TS_ASSERT_DIFFERS(explicitArena.hugePages(), tools::Arena::NoHugePages);
+
+		T *array = explicitArena.allocate<T>(1000);
+		tools::Arena::firstTouch(array, 1000);
+		for (unsigned int i = 0; i < 1000; i++)
+			TS_ASSERT_EQUALS(array[i], 0);
+	}
+
+	/**
+	 * The engine computes the same with the net updates from an arena
+	 */
+	void testWavePropagation(void) {
+		scenarios::DamBreak scenario(size);
+
+		std::vector<T> h(size+2), hu(size+2), b(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		tools::Arena arena(3 * tools::Arena::bytes<T>(size+2) + WavePropagation::arenaBytes(size));
+		T *hArena = arena.allocate<T>(size+2);
+		T *huArena = arena.allocate<T>(size+2);
+		T *bArena = arena.allocate<T>(size+2);
+		scenarios::init(scenario, hArena, huArena, bArena, size);
+
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		WavePropagation arenaPropagation(hArena, huArena, bArena, size, scenario.getCellSize(), arena);
+
+		for (unsigned int step = 0; step < 20; step++) {
+			wavePropagation.setOutflowBoundaryConditions();
+			arenaPropagation.setOutflowBoundaryConditions();
+
+			T dt = wavePropagation.computeNumericalFluxes();
+			TS_ASSERT_EQUALS(arenaPropagation.computeNumericalFluxes(), dt);
+			wavePropagation.updateUnknowns(dt);
+			arenaPropagation.updateUnknowns(dt);
+		}
+
+		for (unsigned int i = 1; i < size+1; i++) {
+			TS_ASSERT_EQUALS(hArena[i], h[i]);
+			TS_ASSERT_EQUALS(huArena[i], hu[i]);
+		}
+	}
+};
+
+#endif /* ARENATEST_H_ */
@@ -0,0 +1,85 @@
+/*
+ * AutotunerTest.h
+ *
+ *  Autotuner and its profile file.
+ */
+
+#ifndef AUTOTUNERTEST_H_
+#define AUTOTUNERTEST_H_
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Autotuner.h"
+#include "../Scenario.h"
+#include "../dambreak.h"
+
+class AutotunerTest : public CxxTest::TestSuite
+{
+private:
+	static const unsigned int size = 2000;
+
+	std::vector<T> h, hu, b;
+	std::string profileFile;
+
+public:
+	void setUp() {
+		scenarios::DamBreak scenario(size);
+		h.resize(size+2);
+		hu.resize(size+2);
+		b.resize(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "/tmp/swe1d-autotuner-%d.profile", getpid());
+		profileFile = name;
+	}
+
+	void tearDown() {
+		std::remove(profileFile.c_str());
+	}
+
+	/**
+	 * The second call reads the configuration from the profile file
+	 */
+	void testProfile(void) {
+		Autotuner autotuner(profileFile, 0.2);
+
+		Autotuner::Configuration config = autotuner.tune("dambreak", &h[0], &hu[0], &b[0], size, 1);
+		TS_ASSERT(!autotuner.fromProfile());
+		TS_ASSERT_LESS_THAN(0u, autotuner.getNumTrials());
+
+		Autotuner::Configuration loaded = autotuner.tune("dambreak", &h[0], &hu[0], &b[0], size, 1);
+		TS_ASSERT(autotuner.fromProfile());
+		TS_ASSERT_EQUALS(loaded.kernel, config.kernel);
+		TS_ASSERT_EQUALS(loaded.numThreads, config.numThreads);
+		TS_ASSERT_EQUALS(loaded.dryBitmap, config.dryBitmap);
+
+		// Other scenario
+		autotuner.tune("shockshock", &h[0], &hu[0], &b[0], size, 1);
+		TS_ASSERT(!autotuner.fromProfile());
+	}
+
+	/**
+	 * A profile tuned with KernelHybrid is not used if only KernelFWave
+	 * is allowed
+	 */
+	void testAllowHybrid(void) {
+		Autotuner autotuner(profileFile, 0.2);
+		autotuner.tune("dambreak", &h[0], &hu[0], &b[0], size, 1);
+
+		autotuner.setAllowHybrid(false);
+		Autotuner::Configuration config = autotuner.tune("dambreak", &h[0], &hu[0], &b[0], size, 1);
+		TS_ASSERT(!autotuner.fromProfile());
+		TS_ASSERT_EQUALS(config.kernel, WavePropagation::KernelFWave);
+
+		config = autotuner.tune("dambreak", &h[0], &hu[0], &b[0], size, 1);
+		TS_ASSERT(autotuner.fromProfile());
+		TS_ASSERT_EQUALS(config.kernel, WavePropagation::KernelFWave);
+	}
+};
+
+#endif /* AUTOTUNERTEST_H_ */
@@ -0,0 +1,111 @@
+/*
+ * BoundaryTest.h
+ *
+ *  Boundary conditions of WavePropagation.
+ */
+
+#ifndef BOUNDARYTEST_H_
+#define BOUNDARYTEST_H_
+
+#include <algorithm>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Scenario.h"
+#include "../WavePropagation.h"
+#include "../dambreak.h"
+#include "../tools/Boundary.h"
+
+class BoundaryTest : public CxxTest::TestSuite
+{
+private:
+	static const unsigned int size = 200;
+
+	std::vector<T> h, hu, b;
+
+	/**
+	 * Runs until endTime with the boundary conditions of the engine
+	 */
+	static void run(WavePropagation &wavePropagation, T endTime) {
+		T t = 0;
+		while (t < endTime) {
+			wavePropagation.setBoundaryConditions(t);
+			T dt = std::min(wavePropagation.computeNumericalFluxes(), endTime - t);
+			wavePropagation.updateUnknowns(dt);
+			t += dt;
+		}
+	}
+
+public:
+	void setUp() {
+		scenarios::DamBreak scenario(size);
+		h.resize(size+2);
+		hu.resize(size+2);
+		b.resize(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+	}
+
+	/**
+	 * Interpolation, clamping and going back in time
+	 */
+	void testHydrograph(void) {
+		std::vector<T> times, discharges;
+		times.push_back(0); discharges.push_back(1);
+		times.push_back(10); discharges.push_back(3);
+		times.push_back(20); discharges.push_back(-1);
+		tools::Boundary hydrograph = tools::Boundary::hydrograph(times, discharges);
+
+		TS_ASSERT_DELTA(hydrograph.discharge(-1), 1, 1e-6);
+		TS_ASSERT_DELTA(hydrograph.discharge(5), 2, 1e-6);
+		TS_ASSERT_DELTA(hydrograph.discharge(15), 1, 1e-6);
+		TS_ASSERT_DELTA(hydrograph.discharge(25), -1, 1e-6);
+		// Rollback
+		TS_ASSERT_DELTA(hydrograph.discharge(2.5), 1.5, 1e-6);
+
+		// Ghost cells
+		hydrograph.apply(5, &h[0], &hu[0], &b[0], size, tools::Boundary::Left);
+		hydrograph.apply(5, &h[0], &hu[0], &b[0], size, tools::Boundary::Right);
+		TS_ASSERT_DELTA(hu[0], 2, 1e-6);
+		TS_ASSERT_DELTA(hu[size+1], -2, 1e-6);
+		TS_ASSERT_EQUALS(h[0], h[1]);
+		TS_ASSERT_EQUALS(h[size+1], h[size]);
+	}
+
+	/**
+	 * Walls keep the water in the domain
+	 */
+	void testWall(void) {
+		scenarios::DamBreak scenario(size);
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		wavePropagation.setBoundary(tools::Boundary::Left, tools::Boundary::wall());
+		wavePropagation.setBoundary(tools::Boundary::Right, tools::Boundary::wall());
+
+		T mass = wavePropagation.getMass();
+		// Long enough for several reflections
+		run(wavePropagation, 200);
+
+		TS_ASSERT_DELTA(wavePropagation.getMass() / mass, 1, 1e-5);
+	}
+
+	/**
+	 * A discharge flows into a closed basin
+	 */
+	void testInflow(void) {
+		std::fill(h.begin(), h.end(), 2);
+		std::fill(hu.begin(), hu.end(), 0);
+		std::fill(b.begin(), b.end(), 0);
+
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, 1);
+		wavePropagation.setBoundary(tools::Boundary::Left, tools::Boundary::inflow(0.5));
+		wavePropagation.setBoundary(tools::Boundary::Right, tools::Boundary::wall());
+
+		T mass = wavePropagation.getMass();
+		run(wavePropagation, 100);
+
+		// The inflow is the discharge of the ghost cell up to the linear
+		// wave that enters the domain
+		TS_ASSERT_DELTA((wavePropagation.getMass() - mass) / (0.5 * 100), 1, 0.01);
+	}
+};
+
+#endif /* BOUNDARYTEST_H_ */
@@ -0,0 +1,211 @@
+/*
+ * DirectWriterTest.h
+ *
+ *  Snapshot output that bypasses the page cache.
+ */
+
+#ifndef DIRECTWRITERTEST_H_
+#define DIRECTWRITERTEST_H_
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../tools/DirectWriter.h"
+
+class DirectWriterTest : public CxxTest::TestSuite
+{
+private:
+	static const unsigned int size = 3000;
+
+	std::vector<T> h, hu, b;
+	std::string directory;
+	std::string fileName;
+
+	/**
+	 * Sets the values of snapshot n
+	 */
+	void fill(unsigned int n) {
+		for (unsigned int i = 0; i < size+2; i++) {
+			h[i] = n + i * 0.5f;
+			hu[i] = n - i * 0.25f;
+			b[i] = -static_cast<T>(i);
+		}
+	}
+
+	/**
+	 * Compares a summary with the cells [begin, end) of values (+ b)
+	 */
+	static void checkSummary(const tools::DirectWriter::Summary &summary,
+			const T *values, const T *b, unsigned int begin, unsigned int end) {
+		T min = values[begin] + (b ? b[begin] : 0);
+		T max = min;
+		double sum = 0;
+		for (unsigned int i = begin; i < end; i++) {
+			T value = values[i] + (b ? b[i] : 0);
+			min = std::min(min, value);
+			max = std::max(max, value);
+			sum += value;
+		}
+
+		TS_ASSERT_EQUALS(summary.min, min);
+		TS_ASSERT_EQUALS(summary.max, max);
+		TS_ASSERT_DELTA(summary.mean, sum / (end - begin), 1e-2);
+	}
+
+	std::string readFile() const {
+		std::ifstream in(fileName.c_str(), std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	/**
+	 * Writes numSnapshots snapshots and checks the records
+	 */
+	void writeAndRead(bool useUring, unsigned int numSnapshots) {
+		{
+			tools::DirectWriter writer(fileName.c_str(), size, 3, useUring);
+			for (unsigned int n = 0; n < numSnapshots; n++) {
+				fill(n);
+				writer.write(n * 0.5f, &h[0], &hu[0], &b[0], size);
+			}
+			writer.finish();
+		}
+
+		const size_t recordBytes = tools::DirectWriter::recordBytes(size);
+		TS_ASSERT_EQUALS(recordBytes % tools::DirectWriter::alignment, 0u);
+
+		std::string file = readFile();
+		TS_ASSERT_EQUALS(file.size(), numSnapshots * recordBytes);
+		if (file.size() != numSnapshots * recordBytes)
+			return;
+
+		for (unsigned int n = 0; n < numSnapshots; n++) {
+			const char *record = file.data() + n * recordBytes;
+
+			tools::DirectWriter::Header header;
+			std::memcpy(&header, record, sizeof(header));
+			TS_ASSERT_EQUALS(std::string(header.magic, 8), "SWE1DRCT");
+			TS_ASSERT_EQUALS(header.valueSize, sizeof(T));
+			TS_ASSERT_EQUALS(header.size, size);
+			TS_ASSERT_EQUALS(header.number, n);
+			TS_ASSERT_EQUALS(header.time, n * 0.5);
+			TS_ASSERT_EQUALS(header.pyramidLevels, 0u);
+
+			fill(n);
+			TS_ASSERT_EQUALS(std::memcmp(record + sizeof(header), &h[1], size * sizeof(T)), 0);
+			TS_ASSERT_EQUALS(std::memcmp(record + sizeof(header) + size * sizeof(T), &hu[1], size * sizeof(T)), 0);
+			TS_ASSERT_EQUALS(std::memcmp(record + sizeof(header) + 2 * size * sizeof(T), &b[1], size * sizeof(T)), 0);
+		}
+	}
+
+public:
+	void setUp() {
+		h.resize(size+2);
+		hu.resize(size+2);
+		b.resize(size+2);
+
+		// Not in /tmp, which is often a tmpfs without O_DIRECT
+		char name[] = "swe1d-direct-XXXXXX";
+		TS_ASSERT(mkdtemp(name));
+		directory = name;
+		fileName = directory + "/snapshots.bin";
+	}
+
+	void tearDown() {
+		std::system(("rm -rf " + directory).c_str());
+	}
+
+	/**
+	 * More snapshots than buffers with io_uring (if available)
+	 */
+	void testUring(void) {
+		writeAndRead(true, 7);
+	}
+
+	void testPwrite(void) {
+		writeAndRead(false, 7);
+	}
+
+	/**
+	 * Each level of the pyramid summarizes its cells, including the
+	 * partial last cell (3000 cells are no power of 7)
+	 */
+	void testPyramid(void) {
+		const unsigned int factor = 7;
+		const unsigned int numSnapshots = 3;
+		{
+			tools::DirectWriter writer(fileName.c_str(), size, 2, true, factor);
+			for (unsigned int n = 0; n < numSnapshots; n++) {
+				fill(n);
+				writer.write(n * 0.5f, &h[0], &hu[0], &b[0], size);
+			}
+			writer.finish();
+		}
+
+		const unsigned int numLevels = tools::DirectWriter::numPyramidLevels(size, factor);
+		TS_ASSERT_EQUALS(numLevels, 5u);
+		TS_ASSERT_EQUALS(tools::DirectWriter::pyramidLevelSize(size, factor, numLevels), 1u);
+
+		std::string file = readFile();
+		TS_ASSERT_EQUALS(file.size(), numSnapshots * tools::DirectWriter::recordBytes(size, factor));
+
+		for (unsigned int n = 0; n < numSnapshots; n++) {
+			fill(n);
+
+			tools::DirectWriter::Header header;
+			std::memcpy(&header, file.data() + n * tools::DirectWriter::recordBytes(size, factor), sizeof(header));
+			TS_ASSERT_EQUALS(header.pyramidFactor, factor);
+			TS_ASSERT_EQUALS(header.pyramidLevels, numLevels);
+
+			unsigned int width = 1;
+			for (unsigned int level = 1; level <= numLevels; level++) {
+				width *= factor;
+
+				const unsigned int levelSize = tools::DirectWriter::pyramidLevelSize(size, factor, level);
+				TS_ASSERT_EQUALS(levelSize, (size + width - 1) / width);
+
+				std::vector<tools::DirectWriter::PyramidCell> cells(levelSize);
+				tools::DirectWriter::readPyramid(fileName.c_str(), size, factor, n, level,
+					0, levelSize, &cells[0]);
+
+				for (unsigned int c = 0; c < levelSize; c++) {
+					const unsigned int begin = c * width + 1;
+					const unsigned int end = std::min((c+1) * width, size) + 1;
+					checkSummary(cells[c].h, &h[0], 0L, begin, end);
+					checkSummary(cells[c].hu, &hu[0], 0L, begin, end);
+					checkSummary(cells[c].eta, &h[0], &b[0], begin, end);
+				}
+
+				// A window in the middle of the level
+				if (levelSize > 2) {
+					tools::DirectWriter::PyramidCell cell;
+					tools::DirectWriter::readPyramid(fileName.c_str(), size, factor, n, level,
+						levelSize/2, levelSize/2 + 1, &cell);
+					TS_ASSERT_EQUALS(std::memcmp(&cell, &cells[levelSize/2], sizeof(cell)), 0);
+				}
+			}
+		}
+
+		std::vector<tools::DirectWriter::PyramidCell> cells(2);
+		TS_ASSERT_THROWS(tools::DirectWriter::readPyramid(fileName.c_str(), size, factor, 0, numLevels+1,
+			0, 1, &cells[0]), std::invalid_argument);
+		TS_ASSERT_THROWS(tools::DirectWriter::readPyramid(fileName.c_str(), size, factor, 0, numLevels,
+			0, 2, &cells[0]), std::invalid_argument);
+	}
+
+	/**
+	 * Snapshots with a different number of cells are rejected
+	 */
+	void testSize(void) {
+		tools::DirectWriter writer(fileName.c_str(), size);
+		TS_ASSERT_THROWS(writer.write(0, &h[0], &hu[0], &b[0], size+1), std::invalid_argument);
+	}
+};
+
+#endif /* DIRECTWRITERTEST_H_ */
@@ -0,0 +1,212 @@
+/*
+ * DistributedWavePropagationTest.h
+ *
+ *  Domain decomposition with ranks connected by shared memory.
+ */
+
+#ifndef DISTRIBUTEDWAVEPROPAGATIONTEST_H_
+#define DISTRIBUTEDWAVEPROPAGATIONTEST_H_
+
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../DistributedWavePropagation.h"
+#include "../Scenario.h"
+#include "../Simulator.h"
+#include "../WavePropagation.h"
+#include "../dambreak.h"
+#include "../tools/HealthCheck.h"
+#include "../tools/ShmTransport.h"
+
+class DistributedWavePropagationTest : public CxxTest::TestSuite
+{
+private:
+	static const unsigned int size = 1000;
+	static const T endTime;
+
+	/** Writer that ignores the checkpoints */
+	struct NullWriter
+	{
+		void write(T, const T*, const T*, const T*, unsigned int)
+		{
+		}
+	};
+
+	/** Run with the health check and an unstable CFL number */
+	bool healthCheck;
+	/** Time steps between two CFL reductions of the ranks */
+	unsigned int cflInterval;
+	unsigned int numCheckpoints;
+
+	/** Single rank solution */
+	std::vector<T> h, hu;
+	unsigned long steps;
+	unsigned int rollbacks;
+
+	/**
+	 * Runs the simulation on one or more ranks
+	 */
+	template<class Engine>
+	void simulate(Engine &wavePropagation, T cellSize,
+			unsigned long &steps, unsigned int &rollbacks) {
+		wavePropagation.setCflNumber(healthCheck ? 1.9f : 0.7f);
+
+		NullWriter writer;
+		Simulator<NullWriter, Engine> simulator(wavePropagation, writer);
+		if (healthCheck)
+			simulator.enableHealthCheck(tools::HealthCheck(cellSize), 10, 3);
+		simulator.run(endTime, numCheckpoints);
+
+		steps = simulator.getSteps();
+		rollbacks = simulator.getRollbacks();
+	}
+
+	/**
+	 * Computes the single rank solution
+	 */
+	void reference() {
+		scenarios::DamBreak scenario(size);
+		std::vector<T> b(size+2);
+		h.resize(size+2);
+		hu.resize(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		simulate(wavePropagation, scenario.getCellSize(), steps, rollbacks);
+	}
+
+	/**
+	 * Runs the dam break on one rank
+	 *
+	 * @param equal output, true if the slab equals the single rank
+	 *  solution bit for bit
+	 */
+	void runRank(const char *name, unsigned int rank, unsigned int numRanks, char &equal) {
+		equal = false;
+		try {
+			tools::ShmTransport transport(name, rank, numRanks);
+
+			unsigned int offset, localSize;
+			DistributedWavePropagation::partition(size, rank, numRanks, offset, localSize);
+
+			scenarios::DamBreak scenario(size);
+			std::vector<T> hLocal(localSize+2), huLocal(localSize+2), bLocal(localSize+2);
+			scenarios::init(scenario, &hLocal[0], &huLocal[0], &bLocal[0], localSize, offset);
+
+			DistributedWavePropagation wavePropagation(transport, &hLocal[0], &huLocal[0], &bLocal[0],
+				localSize, scenario.getCellSize());
+			if (cflInterval > 1)
+				// Any growth of the wave speeds violates the bound
+				wavePropagation.setDeferredCfl(cflInterval, 1);
+
+			unsigned long localSteps;
+			unsigned int localRollbacks;
+			simulate(wavePropagation, scenario.getCellSize(), localSteps, localRollbacks);
+
+			equal = (localRollbacks == rollbacks);
+			if (cflInterval > 1)
+				// The redone time steps are not counted
+				equal &= (wavePropagation.getNumFallbacks() > 0);
+			else
+				equal &= (localSteps == steps);
+			for (unsigned int i = 1; i < localSize+1; i++)
+				equal &= (hLocal[i] == h[offset+i] && huLocal[i] == hu[offset+i]);
+		} catch (...) {
+		}
+	}
+
+	/**
+	 * Runs the dam break with numRanks ranks. The ranks are threads
+	 * (forked processes cannot use OpenMP once the parent did), each with
+	 * its own mapping of the segment.
+	 *
+	 * @return True if all ranks match the single rank solution
+	 */
+	bool run(unsigned int numRanks) {
+		char name[64];
+		std::snprintf(name, sizeof(name), "/swe1d-test-%d-%u", getpid(), numRanks);
+
+		std::vector<char> equal(numRanks);
+		std::vector<std::thread> ranks;
+		for (unsigned int rank = 0; rank < numRanks; rank++)
+			ranks.push_back(std::thread(&DistributedWavePropagationTest::runRank, this,
+				name, rank, numRanks, std::ref(equal[rank])));
+
+		bool result = true;
+		for (unsigned int rank = 0; rank < numRanks; rank++) {
+			ranks[rank].join();
+			result &= (equal[rank] != 0);
+		}
+		return result;
+	}
+
+public:
+	void setUp() {
+		healthCheck = false;
+		cflInterval = 1;
+		numCheckpoints = 4;
+		reference();
+	}
+
+	/**
+	 * The slabs cover the domain without gaps
+	 */
+	void testPartition(void) {
+		for (unsigned int numRanks = 1; numRanks < 8; numRanks++) {
+			unsigned int next = 0;
+			for (unsigned int rank = 0; rank < numRanks; rank++) {
+				unsigned int offset, localSize;
+				DistributedWavePropagation::partition(size+3, rank, numRanks, offset, localSize);
+				TS_ASSERT_EQUALS(offset, next);
+				TS_ASSERT_LESS_THAN_EQUALS(localSize, (size+3) / numRanks + 1);
+				next = offset + localSize;
+			}
+			TS_ASSERT_EQUALS(next, size+3);
+		}
+	}
+
+	/**
+	 * Any number of ranks computes the same as one rank
+	 */
+	void testRanks(void) {
+		TS_ASSERT(run(2));
+		TS_ASSERT(run(3));
+		TS_ASSERT(run(4));
+	}
+
+	/**
+	 * A problem on one rank rolls back all ranks (the dam is only on the
+	 * middle ranks)
+	 */
+	void testHealthCheck(void) {
+		healthCheck = true;
+		reference();
+		TS_ASSERT_LESS_THAN_EQUALS(1u, rollbacks);
+
+		TS_ASSERT(run(3));
+		TS_ASSERT(run(4));
+	}
+
+	/**
+	 * A violated wave speed bound of the deferred CFL reduction redoes
+	 * the time steps with exact reductions. The checkpoint is the first
+	 * reduction after the initial one, so all time steps are redone the
+	 * same way as without the deferred reduction.
+	 */
+	void testDeferredCfl(void) {
+		numCheckpoints = 1;
+		reference();
+
+		cflInterval = 100000;
+		TS_ASSERT(run(2));
+		TS_ASSERT(run(4));
+	}
+};
+
+const T DistributedWavePropagationTest::endTime = 20;
+
+#endif /* DISTRIBUTEDWAVEPROPAGATIONTEST_H_ */
@@ -1,9 +1,17 @@
 
 #ifndef FWAVE_HPP_
 #define FWAVE_HPP_
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include "../tools/Instrumentation.h"
+// The per-edge checks are expensive, use tools::HealthCheck instead
+#ifdef SWE1D_EDGE_ASSERTS
+#define SWE1D_EDGE_ASSERT(condition) assert(condition)
+#else
+#define SWE1D_EDGE_ASSERT(condition) ((void) 0)
+#endif
 	namespace solver {
 		template <typename T> class FWave;
 	}
@@ -20,9 +28,9 @@
 			WetDry,
 			DryWet
 		};
-		static const T g = 9.81;
-		static const T zeroTol = 0.0000001;
-		static const T dryTol = 0.01;
+		static constexpr T g = 9.81;
+		static constexpr T zeroTol = 0.0000001;
+		static constexpr T dryTol = 0.01;
 		/**
 		 * Compute left and right going net-updates.
 		 *
@@ -47,7 +55,7 @@
 			qr.hu = hur;
 
 			//waterheight should be always above the ground and h != 0 to prevent division by 0
-			assert(ql.h > zeroTol && qr.h > zeroTol);
+			SWE1D_EDGE_ASSERT(ql.h > zeroTol && qr.h > zeroTol);
 
 			outhl = outhr = outhul = outhur = (T)0;
 			outmaxWS = 0;
@@ -106,6 +114,29 @@
 				outhl = outhul = (T)0;
 			}
 		};
+		/**
+		 * Compute the net-updates of a batch of edges. Edge i lies between cell i and cell i+1.
+		 *
+		 * @param h heights of numEdges + 1 cells.
+		 * @param hu momentums of numEdges + 1 cells.
+		 * @param b bathymetry of numEdges + 1 cells.
+		 * @param numEdges number of edges.
+		 *
+		 * @param outhl output heights of the cells on the left side of the edges.
+		 * @param outhr output heights of the cells on the right side of the edges.
+		 * @param outhul output momentums of the cells on the left side of the edges.
+		 * @param outhur output momentums of the cells on the right side of the edges.
+		 * @return Maximum wave speed of all edges.
+		 */
+		T computeNetUpdates(const T *h, const T *hu, const T *b, unsigned int numEdges, T *outhl, T *outhr, T *outhul, T *outhur) {
+			T maxWS = 0;
+			for(unsigned int i = 0; i < numEdges; i++) {
+				T edgeWS;
+				computeNetUpdates(h[i], h[i+1], hu[i], hu[i+1], b[i], b[i+1], outhl[i], outhr[i], outhul[i], outhur[i], edgeWS);
+				maxWS = std::max(maxWS, edgeWS);
+			}
+			return maxWS;
+		};
 	private:
 		/**
 		 * Look up the height of both sides and determine the property of the edge as celltype.
@@ -118,6 +149,7 @@
 			if(ql.h < dryTol){
 				if(qr.h < dryTol){
 					//Dry-Dry: Nothing changes
+					INSTR_COUNT(EdgesDryDry);
 					return DryDry;
 				}else{
 					//Dry-Wet: Right incoming wave get reflected
@@ -125,6 +157,7 @@
 					ql.h = qr.h;
 					ql.hu = -qr.hu;
 					bl = br;
+					INSTR_COUNT(EdgesDryWet);
 					return DryWet;
 				}
 			}else{
@@ -133,9 +166,11 @@
 					qr.h = ql.h;
 					qr.hu = -ql.hu;
 					br = bl;
+					INSTR_COUNT(EdgesWetDry);
 					return WetDry;
 				}else{
 					//Wet-Wet: Nothing changes
+					INSTR_COUNT(EdgesWetWet);
 					return WetWet;
 				}
 			}
@@ -215,7 +250,10 @@
 
 			T det = (a*d - b*c);
 
-			assert(std::fabs(det) > zeroTol);
+			if(std::fabs(det) <= zeroTol)
+				INSTR_COUNT(DegenerateDeterminants);
+
+			SWE1D_EDGE_ASSERT(std::fabs(det) > zeroTol);
 
 			m[0][0] = (1.0f / det) * d;
 			m[0][1] = (1.0f / det) * (-b);
@@ -234,5 +272,9 @@
 			out[1] = ec*lambda;
 		};
 	};
+	// Definitions for odr-uses (e.g. std::max(h, dryTol))
+	template <typename T> constexpr T solver::FWave<T>::g;
+	template <typename T> constexpr T solver::FWave<T>::zeroTol;
+	template <typename T> constexpr T solver::FWave<T>::dryTol;
 #endif /* FWAVE_HPP_ */
 
@@ -0,0 +1,623 @@
+/*
+ * FWaveFuzzTest.h
+ *
+ *  Differential fuzzing of the optimized net update kernels against the
+ *  scalar reference solver::FWave::computeNetUpdates (one edge).
+ *
+ *  Random edges are generated in all regimes (dry, near dryTol, wet/dry,
+ *  subsonic, supersonic, near-critical flow with a wave speed close to
+ *  zero, large bathymetry jumps). Each output of a kernel has to match
+ *  the reference within a budget of ULPs or, for outputs that cancel,
+ *  relative to the magnitude of the fluxes of the edge. The first
+ *  failing edge is shrunk to a minimal single-edge reproducer.
+ *
+ *  More edges or another seed: SWE1D_FUZZ_EDGES, SWE1D_FUZZ_SEED.
+ *
+ *  New kernels (SIMD, closed-form, mixed precision) are added as another
+ *  Kernel in the test methods below.
+ */
+
+#ifndef FWAVEFUZZTEST_H_
+#define FWAVEFUZZTEST_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../WavePropagation.h"
+#include "FWave.hpp"
+
+class FWaveFuzzTest : public CxxTest::TestSuite
+{
+public:
+	/** A batched kernel under test */
+	class Kernel
+	{
+	public:
+		virtual ~Kernel() {}
+
+		virtual const char* name() const = 0;
+
+		/**
+		 * Same interface as solver::FWave::computeNetUpdates for a batch
+		 *
+		 * @return Maximum wave speed of all edges
+		 */
+		virtual T run(const T *h, const T *hu, const T *b, unsigned int numEdges,
+			T *outhl, T *outhr, T *outhul, T *outhur) = 0;
+
+		/**
+		 * @return True if the net updates of edges between two dry cells
+		 *  are not written (they are zero)
+		 */
+		virtual bool skipsDryDry() const
+		{
+			return false;
+		}
+	};
+
+	/** Allowed deviation of one output */
+	struct Budget
+	{
+		/** Distance in units in the last place */
+		int64_t maxUlps;
+		/** Deviation relative to the flux scale of the edge */
+		T relTol;
+	};
+
+	enum Output {
+		HNetUpdateLeft,
+		HNetUpdateRight,
+		HuNetUpdateLeft,
+		HuNetUpdateRight,
+		MaxWaveSpeed,
+		NumOutputs
+	};
+
+	enum Regime {
+		/** Both cells dry (zeroTol < h < dryTol) */
+		DryDry,
+		/** Heights within 1% of dryTol */
+		NearDry,
+		WetDry,
+		DryWet,
+		Subsonic,
+		Supersonic,
+		/** |u| within 0.1% of sqrt(g*h), one wave speed close to zero */
+		NearCritical,
+		/** Bathymetry jump of up to 20 times the height */
+		BathymetryJump,
+		NumRegimes
+	};
+
+private:
+	/** One edge */
+	struct Edge
+	{
+		T hl, hr, hul, hur, bl, br;
+	};
+
+	/** Budgets of all outputs */
+	Budget m_budgets[NumOutputs];
+
+	unsigned int m_seed;
+	unsigned int m_numEdges;
+
+	/** Reference solver */
+	solver::FWave<T> m_reference;
+
+public:
+	FWaveFuzzTest()
+	{
+		for (unsigned int i = 0; i < NumOutputs; i++) {
+			m_budgets[i].maxUlps = 4;
+			m_budgets[i].relTol = 1e-5;
+		}
+
+		m_seed = getenv("SWE1D_FUZZ_SEED") ? atoi(getenv("SWE1D_FUZZ_SEED")) : 1;
+		m_numEdges = getenv("SWE1D_FUZZ_EDGES") ? atoi(getenv("SWE1D_FUZZ_EDGES")) : 100000;
+	}
+
+	/**
+	 * solver::FWave on a batch of edges
+	 */
+	void testFWaveBatch(void) {
+		class FWaveBatch : public Kernel
+		{
+			solver::FWave<T> m_fwave;
+		public:
+			const char* name() const { return "fwave_batch"; }
+			T run(const T *h, const T *hu, const T *b, unsigned int numEdges,
+					T *outhl, T *outhr, T *outhul, T *outhur) {
+				return m_fwave.computeNetUpdates(h, hu, b, numEdges, outhl, outhr, outhul, outhur);
+			}
+		} kernel;
+
+		TS_ASSERT(fuzz(kernel));
+	}
+
+	/**
+	 * solver::FWave<double>, rounded to T. Within the default budgets,
+	 * except where the precision decides a threshold: near-critical edges
+	 * (a wave speed within the round-off of T from zero goes to the other
+	 * side) and heights of T(dryTol), which are below the double dryTol.
+	 */
+	void testFWaveDouble(void) {
+		class FWaveDouble : public Kernel
+		{
+			solver::FWave<double> m_fwave;
+		public:
+			const char* name() const { return "fwave_double"; }
+			T run(const T *h, const T *hu, const T *b, unsigned int numEdges,
+					T *outhl, T *outhr, T *outhul, T *outhur) {
+				std::vector<double> hd(h, h + numEdges+1), hud(hu, hu + numEdges+1), bd(b, b + numEdges+1);
+				std::vector<double> out(4 * numEdges);
+				double maxWaveSpeed = m_fwave.computeNetUpdates(&hd[0], &hud[0], &bd[0], numEdges,
+					&out[0], &out[numEdges], &out[2*numEdges], &out[3*numEdges]);
+				std::copy(out.begin(), out.begin() + numEdges, outhl);
+				std::copy(out.begin() + numEdges, out.begin() + 2*numEdges, outhr);
+				std::copy(out.begin() + 2*numEdges, out.begin() + 3*numEdges, outhul);
+				std::copy(out.begin() + 3*numEdges, out.end(), outhur);
+				return maxWaveSpeed;
+			}
+		} kernel;
+
+		// The maximum wave speed of all edges has no edge and no regime
+		Edge edge = Edge();
+		Regime regime = NumRegimes;
+		if (!fuzz(kernel, &edge, false, &regime)) {
+			const T dryTol = solver::FWave<T>::dryTol;
+			TS_ASSERT(regime == NearCritical || edge.hl == dryTol || edge.hr == dryTol);
+		}
+	}
+
+	/**
+	 * WavePropagation (multithreaded for large batches)
+	 */
+	void testWavePropagation(void) {
+		EngineKernel kernel(false);
+		TS_ASSERT(fuzz(kernel));
+	}
+
+	/**
+	 * WavePropagation with the wet/dry bitmap
+	 */
+	void testDryBitmap(void) {
+		EngineKernel kernel(true);
+		TS_ASSERT(fuzz(kernel));
+	}
+
+	/**
+	 * A broken kernel is found and shrunk to a simple reproducer
+	 */
+	void testShrink(void) {
+		class Broken : public Kernel
+		{
+			solver::FWave<T> m_fwave;
+		public:
+			const char* name() const { return "broken"; }
+			T run(const T *h, const T *hu, const T *b, unsigned int numEdges,
+					T *outhl, T *outhr, T *outhul, T *outhur) {
+				T maxWaveSpeed = m_fwave.computeNetUpdates(h, hu, b, numEdges, outhl, outhr, outhul, outhur);
+				// Wrong if the left cell is deep
+				for (unsigned int i = 0; i < numEdges; i++) {
+					if (h[i] > 5)
+						outhul[i] *= 1.001f;
+				}
+				return maxWaveSpeed;
+			}
+		} kernel;
+
+		Edge edge;
+		TS_ASSERT(!fuzz(kernel, &edge, false));
+
+		// Only the left height matters
+		TS_ASSERT_LESS_THAN(5, edge.hl);
+		TS_ASSERT_EQUALS(edge.bl, 0);
+		TS_ASSERT_EQUALS(edge.br, 0);
+		TS_ASSERT_EQUALS(edge.hur, 0);
+	}
+
+private:
+	/**
+	 * WavePropagation on the cells of the batch
+	 */
+	class EngineKernel : public Kernel
+	{
+		const bool m_dryBitmap;
+	public:
+		EngineKernel(bool dryBitmap) : m_dryBitmap(dryBitmap) {}
+		const char* name() const { return m_dryBitmap ? "engine_drybitmap" : "engine"; }
+		bool skipsDryDry() const { return m_dryBitmap; }
+		T run(const T *h, const T *hu, const T *b, unsigned int numEdges,
+				T *outhl, T *outhr, T *outhul, T *outhur) {
+			// The engine needs writable cells (numEdges - 1 cells + 2 ghost cells)
+			std::vector<T> hCopy(h, h + numEdges+1), huCopy(hu, hu + numEdges+1), bCopy(b, b + numEdges+1);
+			WavePropagation wavePropagation(&hCopy[0], &huCopy[0], &bCopy[0], numEdges-1, 1);
+			wavePropagation.setDryBitmap(m_dryBitmap);
+
+			T maxWaveSpeed = wavePropagation.computeNetUpdates(0, numEdges);
+			for (unsigned int i = 0; i < numEdges; i++)
+				wavePropagation.getNetUpdates(i, outhl[i], outhr[i], outhul[i], outhur[i]);
+			return maxWaveSpeed;
+		}
+	};
+
+	/**
+	 * Compares the kernel with the reference on random edges
+	 *
+	 * @param failingEdge output, the shrunk failing edge
+	 * @param report print the failure
+	 * @param failingRegime output, the regime of the failing edge
+	 * @return True if all edges are within the budgets
+	 */
+	bool fuzz(Kernel &kernel, Edge *failingEdge = 0L, bool report = true, Regime *failingRegime = 0L)
+	{
+		// Even edges are generated in a regime, odd edges connect them
+		const unsigned int numCells = m_numEdges + 1;
+		std::vector<T> h(numCells), hu(numCells), b(numCells);
+		std::vector<Regime> regimes(m_numEdges);
+
+		unsigned int seed = m_seed;
+		for (unsigned int i = 0; i+1 < numCells; i += 2) {
+			Regime regime = static_cast<Regime>(random(seed, 0, NumRegimes));
+			Edge edge = generate(seed, regime);
+			h[i] = edge.hl; h[i+1] = edge.hr;
+			hu[i] = edge.hul; hu[i+1] = edge.hur;
+			b[i] = edge.bl; b[i+1] = edge.br;
+
+			regimes[i] = regime;
+			if (i+1 < m_numEdges)
+				regimes[i+1] = regime;
+		}
+		if (numCells % 2) {
+			Edge edge = generate(seed, Subsonic);
+			h[numCells-1] = edge.hl;
+			hu[numCells-1] = edge.hul;
+			b[numCells-1] = edge.bl;
+		}
+
+		std::vector<T> out(4 * m_numEdges);
+		T maxWaveSpeed = kernel.run(&h[0], &hu[0], &b[0], m_numEdges,
+			&out[0], &out[m_numEdges], &out[2*m_numEdges], &out[3*m_numEdges]);
+
+		T referenceMaxWaveSpeed = 0;
+		for (unsigned int i = 0; i < m_numEdges; i++) {
+			Edge edge = { h[i], h[i+1], hu[i], hu[i+1], b[i], b[i+1] };
+			T actual[NumOutputs] = { out[i], out[m_numEdges+i], out[2*m_numEdges+i], out[3*m_numEdges+i], 0 };
+
+			T expected[NumOutputs];
+			solve(edge, expected);
+			referenceMaxWaveSpeed = std::max(referenceMaxWaveSpeed, expected[MaxWaveSpeed]);
+
+			if (kernel.skipsDryDry() && isDry(edge.hl) && isDry(edge.hr))
+				continue;
+
+			int output = firstMismatch(edge, expected, actual, HuNetUpdateRight);
+			if (output < 0)
+				continue;
+
+			Edge shrunk = shrink(kernel, edge);
+			if (report)
+				printFailure(kernel, i, regimes[i], static_cast<Output>(output), expected[output], actual[output], shrunk);
+			if (failingEdge)
+				*failingEdge = shrunk;
+			if (failingRegime)
+				*failingRegime = regimes[i];
+			return false;
+		}
+
+		// The maximum of all edges
+		if (!withinBudget(MaxWaveSpeed, referenceMaxWaveSpeed, maxWaveSpeed, referenceMaxWaveSpeed)) {
+			if (report)
+				std::printf("%s: maximum wave speed %.9g, expected %.9g (seed %u)\n",
+					kernel.name(), maxWaveSpeed, referenceMaxWaveSpeed, m_seed);
+			return false;
+		}
+
+		return true;
+	}
+
+	/**
+	 * @return Random edge in the regime
+	 */
+	static Edge generate(unsigned int &seed, Regime regime)
+	{
+		const T dryTol = solver::FWave<T>::dryTol;
+		const T zeroTol = solver::FWave<T>::zeroTol;
+		const T g = solver::FWave<T>::g;
+
+		Edge edge;
+		edge.bl = edge.br = 0;
+		if (random(seed, 0, 1) < 0.5) {
+			edge.bl = random(seed, -10, 0);
+			edge.br = edge.bl + random(seed, -0.5, 0.5);
+		}
+
+		switch (regime) {
+		case DryDry:
+			edge.hl = random(seed, 10 * zeroTol, dryTol);
+			edge.hr = random(seed, 10 * zeroTol, dryTol);
+			edge.hul = edge.hl * random(seed, -1, 1);
+			edge.hur = edge.hr * random(seed, -1, 1);
+			break;
+		case NearDry:
+			edge.hl = dryTol * random(seed, 0.99, 1.01);
+			edge.hr = dryTol * random(seed, 0.99, 1.01);
+			edge.hul = edge.hl * random(seed, -0.3, 0.3);
+			edge.hur = edge.hr * random(seed, -0.3, 0.3);
+			break;
+		case WetDry:
+		case DryWet:
+			edge.hl = random(seed, 0.1, 10);
+			edge.hr = random(seed, 10 * zeroTol, dryTol);
+			edge.hul = edge.hl * random(seed, -2, 2);
+			edge.hur = 0;
+			if (regime == DryWet) {
+				std::swap(edge.hl, edge.hr);
+				std::swap(edge.hul, edge.hur);
+			}
+			break;
+		case Subsonic:
+			edge.hl = random(seed, 0.1, 100);
+			edge.hr = random(seed, 0.1, 100);
+			edge.hul = edge.hl * random(seed, -0.9, 0.9) * std::sqrt(g * edge.hl);
+			edge.hur = edge.hr * random(seed, -0.9, 0.9) * std::sqrt(g * edge.hr);
+			break;
+		case Supersonic:
+			{
+				T dir = random(seed, -1, 1) < 0 ? -1 : 1;
+				edge.hl = random(seed, 0.05, 2);
+				edge.hr = random(seed, 0.05, 2);
+				edge.hul = dir * edge.hl * random(seed, 1.5, 10) * std::sqrt(g * edge.hl);
+				edge.hur = dir * edge.hr * random(seed, 1.5, 10) * std::sqrt(g * edge.hr);
+			}
+			break;
+		case NearCritical:
+			{
+				T dir = random(seed, -1, 1) < 0 ? -1 : 1;
+				edge.hl = random(seed, 0.1, 10);
+				edge.hr = edge.hl * random(seed, 0.999, 1.001);
+				edge.hul = dir * edge.hl * random(seed, 0.999, 1.001) * std::sqrt(g * edge.hl);
+				edge.hur = dir * edge.hr * random(seed, 0.999, 1.001) * std::sqrt(g * edge.hr);
+			}
+			break;
+		case BathymetryJump:
+			edge.hl = random(seed, 0.1, 10);
+			edge.hr = random(seed, 0.1, 10);
+			edge.hul = edge.hl * random(seed, -1, 1);
+			edge.hur = edge.hr * random(seed, -1, 1);
+			edge.bl = random(seed, -20, 20) * edge.hl;
+			edge.br = random(seed, -20, 20) * edge.hr;
+			break;
+		case NumRegimes:
+			break;
+		}
+
+		return edge;
+	}
+
+	/**
+	 * Runs the reference on one edge
+	 */
+	void solve(const Edge &edge, T out[NumOutputs])
+	{
+		m_reference.computeNetUpdates(edge.hl, edge.hr, edge.hul, edge.hur, edge.bl, edge.br,
+			out[HNetUpdateLeft], out[HNetUpdateRight], out[HuNetUpdateLeft], out[HuNetUpdateRight],
+			out[MaxWaveSpeed]);
+	}
+
+	/**
+	 * @return The first output (up to last) that is not within its budget, -1 if none
+	 */
+	int firstMismatch(const Edge &edge, const T expected[], const T actual[], int last) const
+	{
+		// Magnitude of the mass and momentum fluxes (for cancellations)
+		T hMax = std::max(edge.hl, edge.hr);
+		T c = std::sqrt(solver::FWave<T>::g * hMax);
+		T u = std::max(std::fabs(edge.hul) / edge.hl, std::fabs(edge.hur) / edge.hr);
+		T hScale = hMax * (u + c);
+		T huScale = hScale * (u + c) + solver::FWave<T>::g * hMax * std::fabs(edge.br - edge.bl);
+		T scales[NumOutputs] = { hScale, hScale, huScale, huScale, u + c };
+
+		for (int i = 0; i <= last; i++) {
+			if (!withinBudget(static_cast<Output>(i), expected[i], actual[i], scales[i]))
+				return i;
+		}
+		return -1;
+	}
+
+	bool withinBudget(Output output, T expected, T actual, T scale) const
+	{
+		if (std::isnan(expected) || std::isnan(actual))
+			return std::isnan(expected) && std::isnan(actual);
+
+		return ulps(expected, actual) <= m_budgets[output].maxUlps
+			|| std::fabs(expected - actual) <= m_budgets[output].relTol * scale;
+	}
+
+	/**
+	 * @return Number of representable values between a and b
+	 */
+	static int64_t ulps(float a, float b)
+	{
+		int32_t ia, ib;
+		std::memcpy(&ia, &a, sizeof(ia));
+		std::memcpy(&ib, &b, sizeof(ib));
+		// Map to a monotonic integer scale (-0 == +0)
+		int64_t la = ia < 0 ? -static_cast<int64_t>(ia & 0x7fffffff) : ia;
+		int64_t lb = ib < 0 ? -static_cast<int64_t>(ib & 0x7fffffff) : ib;
+		return la > lb ? la - lb : lb - la;
+	}
+
+	static int64_t ulps(double a, double b)
+	{
+		int64_t ia, ib;
+		std::memcpy(&ia, &a, sizeof(ia));
+		std::memcpy(&ib, &b, sizeof(ib));
+		ia = ia < 0 ? -(ia & 0x7fffffffffffffffll) : ia;
+		ib = ib < 0 ? -(ib & 0x7fffffffffffffffll) : ib;
+		// Saturates instead of overflowing
+		if ((ia < 0) != (ib < 0))
+			return INT64_MAX;
+		return ia > ib ? ia - ib : ib - ia;
+	}
+
+	/**
+	 * @return True if the kernel fails on this single edge
+	 */
+	bool fails(Kernel &kernel, const Edge &edge)
+	{
+		// Two cells, one edge
+		T h[] = { edge.hl, edge.hr };
+		T hu[] = { edge.hul, edge.hur };
+		T b[] = { edge.bl, edge.br };
+		T actual[NumOutputs];
+		actual[MaxWaveSpeed] = kernel.run(h, hu, b, 1, &actual[HNetUpdateLeft], &actual[HNetUpdateRight],
+			&actual[HuNetUpdateLeft], &actual[HuNetUpdateRight]);
+
+		if (kernel.skipsDryDry() && isDry(edge.hl) && isDry(edge.hr))
+			return false;
+
+		T expected[NumOutputs];
+		solve(edge, expected);
+		return firstMismatch(edge, expected, actual, MaxWaveSpeed) >= 0;
+	}
+
+	/**
+	 * Simplifies a failing edge as long as it still fails: removes the
+	 * bathymetry and the momentums, makes the sides equal and rounds the
+	 * values to few significant bits. Each step has to make the edge
+	 * simpler (see simpler()), so the shrinking ends.
+	 *
+	 * @return The simplified edge, the edge itself if it does not fail
+	 *  alone (the failure depends on the neighbours in the batch)
+	 */
+	Edge shrink(Kernel &kernel, Edge edge)
+	{
+		if (!fails(kernel, edge))
+			return edge;
+
+		bool changed = true;
+		while (changed) {
+			changed = false;
+
+			std::vector<Edge> candidates;
+			Edge e = edge;
+			e.bl = e.br = 0; candidates.push_back(e);
+			e = edge; e.br = e.bl; candidates.push_back(e);
+			e = edge; e.bl = 0; e.br -= edge.bl; candidates.push_back(e);
+			e = edge; e.hul = 0; candidates.push_back(e);
+			e = edge; e.hur = 0; candidates.push_back(e);
+			e = edge; e.hur = e.hul; candidates.push_back(e);
+			e = edge; e.hr = e.hl; candidates.push_back(e);
+			e = edge; e.hl = e.hr; candidates.push_back(e);
+
+			// Fewer significant bits, one value at a time
+			T Edge::*values[] = { &Edge::hl, &Edge::hr, &Edge::hul, &Edge::hur, &Edge::bl, &Edge::br };
+			for (unsigned int v = 0; v < 6; v++) {
+				for (int bits = 1; bits < 24; bits++) {
+					e = edge;
+					e.*values[v] = round(edge.*values[v], bits);
+					if (e.*values[v] != edge.*values[v]) {
+						candidates.push_back(e);
+						break;
+					}
+				}
+			}
+
+			for (unsigned int i = 0; i < candidates.size() && !changed; i++) {
+				if (simpler(candidates[i], edge) && fails(kernel, candidates[i])) {
+					edge = candidates[i];
+					changed = true;
+				}
+			}
+		}
+
+		return edge;
+	}
+
+	/**
+	 * @return True if a has fewer significant bits in total than b, or as
+	 *  many but fewer distinct values
+	 */
+	static bool simpler(const Edge &a, const Edge &b)
+	{
+		int bitsA = 0, bitsB = 0;
+		T Edge::*values[] = { &Edge::hl, &Edge::hr, &Edge::hul, &Edge::hur, &Edge::bl, &Edge::br };
+		for (unsigned int v = 0; v < 6; v++) {
+			bitsA += significantBits(a.*values[v]);
+			bitsB += significantBits(b.*values[v]);
+		}
+		if (bitsA != bitsB)
+			return bitsA < bitsB;
+
+		return distinctValues(a) < distinctValues(b);
+	}
+
+	static int significantBits(T value)
+	{
+		int bits = 0;
+		while (bits < 24 && round(value, bits) != value)
+			bits++;
+		return bits;
+	}
+
+	static int distinctValues(const Edge &edge)
+	{
+		T values[] = { edge.hl, edge.hr, edge.hul, edge.hur, edge.bl, edge.br };
+		std::sort(values, values + 6);
+		return std::unique(values, values + 6) - values;
+	}
+
+	/**
+	 * @return value rounded to bits significant bits
+	 */
+	static T round(T value, int bits)
+	{
+		if (value == 0 || !std::isfinite(value))
+			return value;
+
+		int exponent;
+		T mantissa = std::frexp(value, &exponent);
+		return std::ldexp(std::floor(std::ldexp(mantissa, bits) + (T)0.5), exponent - bits);
+	}
+
+	void printFailure(const Kernel &kernel, unsigned int edge, Regime regime, Output output,
+			T expected, T actual, const Edge &shrunk) const
+	{
+		const char* outputs[] = { "hNetUpdateLeft", "hNetUpdateRight", "huNetUpdateLeft",
+			"huNetUpdateRight", "maxWaveSpeed" };
+		const char* regimes[] = { "drydry", "neardry", "wetdry", "drywet", "subsonic",
+			"supersonic", "nearcritical", "bathymetryjump" };
+
+		std::printf("%s: %s of edge %u (%s, seed %u) is %.9g, expected %.9g (%lld ulps)\n",
+			kernel.name(), outputs[output], edge, regimes[regime], m_seed,
+			actual, expected, static_cast<long long>(ulps(expected, actual)));
+		std::printf("  reproducer: hl = %.9g, hr = %.9g, hul = %.9g, hur = %.9g, bl = %.9g, br = %.9g\n",
+			shrunk.hl, shrunk.hr, shrunk.hul, shrunk.hur, shrunk.bl, shrunk.br);
+	}
+
+	static bool isDry(T h)
+	{
+		return h < solver::FWave<T>::dryTol;
+	}
+
+	/**
+	 * @return Uniform random number in [min, max)
+	 */
+	static double random(unsigned int &seed, double min, double max)
+	{
+		// Numerical Recipes LCG, reproducible on all platforms
+		seed = 1664525u * seed + 1013904223u;
+		return min + (max - min) * (seed >> 8) / 16777216.;
+	}
+};
+
+#endif /* FWAVEFUZZTEST_H_ */
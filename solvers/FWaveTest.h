@@ -20,7 +20,7 @@ private:
 
 public:
 	/** Delta used for comparing expected and actual values */
-	static const T delta = 0.0001f;
+	static constexpr T delta = 0.0001f;
 
 	/** FWave to test */
 	solver::FWave<T> fwave;
@@ -773,5 +773,6 @@ public:
 	}
 };
 
+constexpr T FWaveTest::delta;
 
 #endif /* FWAVETEST_H_ */
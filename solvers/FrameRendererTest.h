@@ -0,0 +1,126 @@
+/*
+ * FrameRendererTest.h
+ *
+ *  In-situ rendering into video frames.
+ */
+
+#ifndef FRAMERENDERERTEST_H_
+#define FRAMERENDERERTEST_H_
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Scenario.h"
+#include "../dambreak.h"
+#include "../tools/FrameRenderer.h"
+
+class FrameRendererTest : public CxxTest::TestSuite
+{
+private:
+	static const unsigned int size = 500;
+
+	std::vector<T> h, hu, b;
+	std::string directory;
+
+	static std::string readFile(const std::string &name) {
+		std::ifstream in(name.c_str(), std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+public:
+	void setUp() {
+		scenarios::DamBreak scenario(size);
+		h.resize(size+2);
+		hu.resize(size+2);
+		b.resize(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		char name[] = "/tmp/swe1d-frames-XXXXXX";
+		TS_ASSERT(mkdtemp(name));
+		directory = name;
+	}
+
+	void tearDown() {
+		std::system(("rm -rf " + directory).c_str());
+	}
+
+	/**
+	 * One PPM file per frame, water below the surface
+	 */
+	void testPPMFiles(void) {
+		{
+			tools::FrameRenderer renderer((directory + "/frame_%03d.ppm").c_str(),
+				tools::FrameRenderer::FormatPPM, 64, 32, 0, 2);
+			renderer.setRange(0, 16);
+			for (unsigned int n = 0; n < 3; n++)
+				renderer.write(n, &h[0], &hu[0], &b[0], size);
+			renderer.finish();
+			TS_ASSERT_EQUALS(renderer.numFrames(), 3u);
+		}
+
+		const std::string header = "P6\n64 32\n255\n";
+		for (unsigned int n = 0; n < 3; n++) {
+			char name[32];
+			std::snprintf(name, sizeof(name), "/frame_%03d.ppm", n);
+			std::string image = readFile(directory + name);
+
+			TS_ASSERT_EQUALS(image.size(), header.size() + 64 * 32 * 3);
+			TS_ASSERT_EQUALS(image.substr(0, header.size()), header);
+
+			// Bottom left pixel is below the surface (14), top left is sky
+			const unsigned char *pixels = reinterpret_cast<const unsigned char*>(image.data() + header.size());
+			TS_ASSERT_EQUALS(pixels[(31 * 64) * 3 + 2], 200);
+			TS_ASSERT_EQUALS(pixels[2], 250);
+		}
+	}
+
+	/**
+	 * All frames in one YUV4MPEG2 stream, in order
+	 */
+	void testY4M(void) {
+		std::string name = directory + "/video.y4m";
+		{
+			tools::FrameRenderer renderer(name.c_str(), tools::FrameRenderer::FormatY4M, 64, 32, 1, 3);
+			// Only the frames at 0, 1 and 2 are rendered
+			for (unsigned int n = 0; n < 10; n++)
+				renderer.write(n * 0.25f, &h[0], &hu[0], &b[0], size);
+			TS_ASSERT_EQUALS(renderer.numFrames(), 3u);
+		}
+
+		const std::string header = "YUV4MPEG2 W64 H32 F25:1 Ip A1:1 C420jpeg\n";
+		std::string video = readFile(name);
+		TS_ASSERT_EQUALS(video.substr(0, header.size()), header);
+		TS_ASSERT_EQUALS(video.size(), header.size() + 3 * (6 + 64 * 32 * 3 / 2));
+	}
+
+	/**
+	 * A command that exits early does not kill the simulation
+	 */
+	void testClosedPipe(void) {
+		// Each frame is larger than the pipe buffer
+		tools::FrameRenderer renderer("|true", tools::FrameRenderer::FormatY4M, 640, 480);
+		for (unsigned int n = 0; n < 5; n++)
+			renderer.write(n, &h[0], &hu[0], &b[0], size);
+
+		TS_ASSERT_THROWS(renderer.finish(), std::runtime_error);
+		// Reported once
+		renderer.finish();
+	}
+
+	/**
+	 * The exit status of the command is reported
+	 */
+	void testFailedCommand(void) {
+		tools::FrameRenderer renderer("|exit 3", tools::FrameRenderer::FormatY4M, 64, 32);
+		renderer.write(0, &h[0], &hu[0], &b[0], size);
+
+		TS_ASSERT_THROWS(renderer.finish(), std::runtime_error);
+	}
+};
+
+#endif /* FRAMERENDERERTEST_H_ */
@@ -0,0 +1,124 @@
+/*
+ * HealthCheckTest.h
+ *
+ *  Health check and rollback of the Simulator.
+ */
+
+#ifndef HEALTHCHECKTEST_H_
+#define HEALTHCHECKTEST_H_
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Scenario.h"
+#include "../Simulator.h"
+#include "../WavePropagation.h"
+#include "../dambreak.h"
+#include "../tools/HealthCheck.h"
+
+class HealthCheckTest : public CxxTest::TestSuite
+{
+private:
+	/** Number of cells (several blocks) */
+	static const unsigned int size = 5000;
+
+	std::vector<T> h, hu, b;
+
+	/** Writer that only counts the checkpoints */
+	struct NullWriter
+	{
+		unsigned int count;
+
+		NullWriter() : count(0) {}
+
+		void write(T, const T*, const T*, const T*, unsigned int)
+		{
+			count++;
+		}
+	};
+
+public:
+	void setUp() {
+		scenarios::DamBreak scenario(size);
+		h.resize(size+2);
+		hu.resize(size+2);
+		b.resize(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+	}
+
+	/**
+	 * Each problem is found in the right cell
+	 */
+	void testProblems(void) {
+		tools::HealthCheck check(1, 1000, 1);
+
+		tools::HealthCheck::Report report = check.check(&h[0], &hu[0], size, 0.01, 7);
+		TS_ASSERT_EQUALS(report.problem, tools::HealthCheck::Healthy);
+
+		h[3000] = std::numeric_limits<T>::quiet_NaN();
+		h[4000] = -1;
+		report = check.check(&h[0], &hu[0], size, 0.01, 7);
+		TS_ASSERT_EQUALS(report.problem, tools::HealthCheck::NotFinite);
+		TS_ASSERT_EQUALS(report.cell, 3000u);
+		TS_ASSERT_EQUALS(report.step, 7ul);
+
+		h[3000] = 10;
+		report = check.check(&h[0], &hu[0], size, 0.01, 7);
+		TS_ASSERT_EQUALS(report.problem, tools::HealthCheck::NegativeDepth);
+		TS_ASSERT_EQUALS(report.cell, 4000u);
+
+		h[4000] = 10;
+		hu[1234] = -2000;
+		report = check.check(&h[0], &hu[0], size, 0.01, 7);
+		TS_ASSERT_EQUALS(report.problem, tools::HealthCheck::ExplodingMomentum);
+		TS_ASSERT_EQUALS(report.cell, 1234u);
+
+		// (|u| + sqrt(g*h)) * dt / dx > 1
+		hu[1234] = 0;
+		report = check.check(&h[0], &hu[0], size, 1, 7);
+		TS_ASSERT_EQUALS(report.problem, tools::HealthCheck::CflViolation);
+		TS_ASSERT_EQUALS(report.cell, 1u);
+		TS_ASSERT_LESS_THAN(1, report.value);
+	}
+
+	/**
+	 * An unstable time step is rolled back and repeated with a smaller one
+	 */
+	void testRollback(void) {
+		scenarios::DamBreak scenario(size);
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		// Unstable
+		wavePropagation.setCflNumber(1.9);
+
+		NullWriter writer;
+		Simulator<NullWriter> simulator(wavePropagation, writer);
+		simulator.enableHealthCheck(tools::HealthCheck(scenario.getCellSize()), 10, 3);
+		simulator.run(10, 2);
+
+		TS_ASSERT_LESS_THAN_EQUALS(1u, simulator.getRollbacks());
+		TS_ASSERT_EQUALS(writer.count, 3u);
+
+		tools::HealthCheck check(scenario.getCellSize());
+		TS_ASSERT_EQUALS(check.check(&h[0], &hu[0], size, 0.001, 0).problem, tools::HealthCheck::Healthy);
+	}
+
+	/**
+	 * Without rollbacks, the simulation stops at the first problem
+	 */
+	void testStop(void) {
+		scenarios::DamBreak scenario(size);
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		wavePropagation.setCflNumber(1.9);
+
+		NullWriter writer;
+		Simulator<NullWriter> simulator(wavePropagation, writer);
+		simulator.enableHealthCheck(tools::HealthCheck(scenario.getCellSize()), 10);
+
+		TS_ASSERT_THROWS(simulator.run(10, 2), std::runtime_error);
+	}
+};
+
+#endif /* HEALTHCHECKTEST_H_ */
@@ -0,0 +1,84 @@
+#ifndef HYBRID_HPP_
+#define HYBRID_HPP_
+#include <algorithm>
+#include <cmath>
+#include "FWave.hpp"
+#include "../tools/Instrumentation.h"
+	namespace solver {
+		template <typename T> class Hybrid;
+	}
+	/**
+	 * Uses a cheap Rusanov (local Lax-Friedrichs) solver on edges where both
+	 * states are nearly equal and FWave everywhere else (shocks, rarefactions,
+	 * wet/dry fronts, bathymetry steps).
+	 *
+	 * The Rusanov net-updates are computed in f-wave form with the surface
+	 * elevation jump, so a lake at rest stays at rest.
+	 */
+	template <typename T> class solver::Hybrid {
+	private:
+		/** Solver for non-smooth edges */
+		FWave<T> m_fwave;
+		/** Maximum relative jump of an edge that is still smooth */
+		T m_smoothTol;
+	public:
+		/**
+		 * @param smoothTol an edge is smooth if the jumps in surface elevation and bathymetry
+		 *  are below smoothTol * h and the velocity jump is below smoothTol * sqrt(g*h).
+		 */
+		Hybrid(T smoothTol = 0.01) : m_smoothTol(smoothTol) {}
+		/**
+		 * Compute left and right going net-updates. Same parameters as FWave::computeNetUpdates.
+		 */
+		void computeNetUpdates(T hl, T hr, T hul, T hur, T bl, T br, T &outhl, T &outhr, T &outhul, T &outhur, T &outmaxWS) {
+			const T g = FWave<T>::g;
+
+			if(hl < FWave<T>::dryTol || hr < FWave<T>::dryTol) {
+				m_fwave.computeNetUpdates(hl, hr, hul, hur, bl, br, outhl, outhr, outhul, outhur, outmaxWS);
+				return;
+			}
+
+			T ul = hul / hl;
+			T ur = hur / hr;
+			T h = (T)0.5 * (hl + hr);
+			T dEta = (hr + br) - (hl + bl);
+			T du = ur - ul;
+			T db = br - bl;
+
+			//Smoothness indicator (squared to avoid the square root)
+			T tol2 = m_smoothTol * m_smoothTol;
+			if(dEta * dEta > tol2 * h * h || db * db > tol2 * h * h || du * du > tol2 * g * h) {
+				m_fwave.computeNetUpdates(hl, hr, hul, hur, bl, br, outhl, outhr, outhul, outhur, outmaxWS);
+				return;
+			}
+			INSTR_COUNT(EdgesSmooth);
+
+			//Flux difference incl. bathymetry source term (as in FWave)
+			T dFlux[] = {hur - hul,
+				hur * ur - hul * ul + (T)0.5 * g * (hr * hr - hl * hl) + g * db * h};
+
+			//Local maximum wave speed
+			T s = std::fabs((hul + hur) / (hl + hr)) + std::sqrt(g * h);
+
+			outhl = (T)0.5 * (dFlux[0] - s * dEta);
+			outhr = (T)0.5 * (dFlux[0] + s * dEta);
+			outhul = (T)0.5 * (dFlux[1] - s * (hur - hul));
+			outhur = (T)0.5 * (dFlux[1] + s * (hur - hul));
+			outmaxWS = s;
+		};
+		/**
+		 * Compute the net-updates of a batch of edges. Same parameters as the batched FWave::computeNetUpdates.
+		 *
+		 * @return Maximum wave speed of all edges.
+		 */
+		T computeNetUpdates(const T *h, const T *hu, const T *b, unsigned int numEdges, T *outhl, T *outhr, T *outhul, T *outhur) {
+			T maxWS = 0;
+			for(unsigned int i = 0; i < numEdges; i++) {
+				T edgeWS;
+				computeNetUpdates(h[i], h[i+1], hu[i], hu[i+1], b[i], b[i+1], outhl[i], outhr[i], outhul[i], outhur[i], edgeWS);
+				maxWS = std::max(maxWS, edgeWS);
+			}
+			return maxWS;
+		};
+	};
+#endif /* HYBRID_HPP_ */
@@ -0,0 +1,148 @@
+/*
+ * HybridTest.h
+ *
+ *  Accuracy of solver::Hybrid compared to solver::FWave.
+ */
+
+#ifndef HYBRIDTEST_H_
+#define HYBRIDTEST_H_
+
+#include <cmath>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "Hybrid.hpp"
+#include "../Scenario.h"
+#include "../WavePropagation.h"
+#include "../dambreak.h"
+#include "../rarerare.h"
+#include "../shockshock.h"
+#include "../SubCriticalFlow.h"
+#include "../SuperCriticalFlow.h"
+
+class HybridTest : public CxxTest::TestSuite
+{
+private:
+	/** Number of cells of the scenario runs */
+	static const unsigned int size = 2000;
+
+	/**
+	 * Runs a scenario until endTime
+	 *
+	 * @param h, hu output, values of all cells (incl. ghost cells)
+	 */
+	template<class Scenario>
+	void run(Scenario &scenario, WavePropagation::Kernel kernel, T endTime,
+			std::vector<T> &h, std::vector<T> &hu) {
+		std::vector<T> b(size+2);
+		h.resize(size+2);
+		hu.resize(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		wavePropagation.setKernel(kernel);
+
+		T t = 0;
+		while (t < endTime) {
+			wavePropagation.setOutflowBoundaryConditions();
+			T dt = std::min(wavePropagation.computeNumericalFluxes(), endTime - t);
+			wavePropagation.updateUnknowns(dt);
+			t += dt;
+		}
+	}
+
+	/**
+	 * @return Relative L1 difference of a and b
+	 */
+	static T relativeL1(const std::vector<T> &a, const std::vector<T> &b) {
+		T diff = 0, norm = 0;
+		for (unsigned int i = 1; i < size+1; i++) {
+			diff += std::fabs(a[i] - b[i]);
+			norm += std::fabs(a[i]);
+		}
+		return diff / norm;
+	}
+
+	/**
+	 * Compares the results of FWave and Hybrid
+	 *
+	 * @param tol maximum relative L1 difference
+	 */
+	template<class Scenario>
+	void compare(Scenario &scenario, T endTime, T tol) {
+		std::vector<T> h, hu, hHybrid, huHybrid;
+		run(scenario, WavePropagation::KernelFWave, endTime, h, hu);
+		run(scenario, WavePropagation::KernelHybrid, endTime, hHybrid, huHybrid);
+
+		TS_ASSERT_LESS_THAN(relativeL1(h, hHybrid), tol);
+		TS_ASSERT_LESS_THAN(relativeL1(hu, huHybrid), tol);
+	}
+
+public:
+	/** Hybrid solver to test */
+	solver::Hybrid<T> hybrid;
+
+	/**
+	 * Tests Hybrid#computeNetUpdates on a lake at rest with a small bathymetry step:<br>
+	 * hl = 10.0, hr = 9.99<br>
+	 * hul = hur = 0<br>
+	 * bl = -10.0, br = -9.99<br>
+	 */
+	void testLakeAtRest(void) {
+		T hl, hr, hul, hur, maxWS;
+
+		hybrid.computeNetUpdates(10.0f, 9.99f, 0.0f, 0.0f, -10.0f, -9.99f, hl, hr, hul, hur, maxWS);
+
+		TS_ASSERT_DELTA(hl, 0.0f, 0.0001f);
+		TS_ASSERT_DELTA(hr, 0.0f, 0.0001f);
+		TS_ASSERT_DELTA(hul, 0.0f, 0.001f);
+		TS_ASSERT_DELTA(hur, 0.0f, 0.001f);
+	}
+
+	/**
+	 * Tests that non-smooth edges give exactly the FWave result:<br>
+	 * hl = 10.0, hr = 5.0<br>
+	 * hul = -2.0, hur = 3.0<br>
+	 */
+	void testShockUsesFWave(void) {
+		solver::FWave<T> fwave;
+		T hl, hr, hul, hur, maxWS;
+		T fhl, fhr, fhul, fhur, fmaxWS;
+
+		hybrid.computeNetUpdates(10.0f, 5.0f, -2.0f, 3.0f, 0.0f, 0.0f, hl, hr, hul, hur, maxWS);
+		fwave.computeNetUpdates(10.0f, 5.0f, -2.0f, 3.0f, 0.0f, 0.0f, fhl, fhr, fhul, fhur, fmaxWS);
+
+		TS_ASSERT_EQUALS(hl, fhl);
+		TS_ASSERT_EQUALS(hr, fhr);
+		TS_ASSERT_EQUALS(hul, fhul);
+		TS_ASSERT_EQUALS(hur, fhur);
+		TS_ASSERT_EQUALS(maxWS, fmaxWS);
+	}
+
+	void testDamBreak(void) {
+		scenarios::DamBreak scenario(size);
+		compare(scenario, 10, 0.01f);
+	}
+
+	void testRareRare(void) {
+		scenarios::RareRare scenario(size, 10);
+		compare(scenario, 5, 0.01f);
+	}
+
+	void testShockShock(void) {
+		scenarios::ShockShock scenario(size, 10);
+		compare(scenario, 5, 0.01f);
+	}
+
+	void testSubCriticalFlow(void) {
+		scenarios::SubCriticalFlow scenario(size);
+		compare(scenario, 30, 0.001f);
+	}
+
+	void testSuperCriticalFlow(void) {
+		scenarios::SuperCriticalFlow scenario(size);
+		compare(scenario, 80, 0.001f);
+	}
+};
+
+#endif /* HYBRIDTEST_H_ */
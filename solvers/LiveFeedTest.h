@@ -0,0 +1,170 @@
+/*
+ * LiveFeedTest.h
+ *
+ *  Shared memory live feed and its sequence locks.
+ */
+
+#ifndef LIVEFEEDTEST_H_
+#define LIVEFEEDTEST_H_
+
+#include <cstdio>
+#include <stdexcept>
+#include <stdint.h>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../tools/LiveFeed.h"
+
+class LiveFeedTest : public CxxTest::TestSuite
+{
+private:
+	static const unsigned int size = 1000;
+	static const unsigned int numFrames = 4;
+
+	char name[64];
+	/** Frame with all values set to one number, size + 2 */
+	std::vector<T> values;
+
+	void fill(T value) {
+		values.assign(size+2, value);
+	}
+
+	/**
+	 * Writes frames with all values set to the frame number
+	 */
+	static void writeFrames(tools::LiveFeed *feed, unsigned int writes) {
+		std::vector<T> frame(size+2);
+		for (unsigned int n = 0; n < writes; n++) {
+			frame.assign(size+2, n);
+			feed->write(n, &frame[0], &frame[0], &frame[0], size);
+		}
+	}
+
+public:
+	void setUp() {
+		std::snprintf(name, sizeof(name), "/swe1d-live-test-%d", getpid());
+	}
+
+	/**
+	 * The reader gets the latest frame
+	 */
+	void testLatest(void) {
+		tools::LiveFeed feed(name, size, numFrames);
+		tools::LiveFeedReader reader(name);
+		TS_ASSERT_EQUALS(reader.size(), size);
+
+		std::vector<T> h(size), hu(size), b(size);
+		double time;
+		TS_ASSERT_EQUALS(reader.readLatest(time, &h[0], &hu[0], &b[0]), -1);
+
+		for (unsigned int n = 0; n < 6; n++) {
+			fill(n);
+			feed.write(n * 0.5, &values[0], &values[0], &values[0], size);
+		}
+
+		TS_ASSERT_EQUALS(reader.count(), 6u);
+		TS_ASSERT_EQUALS(reader.readLatest(time, &h[0], &hu[0], &b[0]), 5);
+		TS_ASSERT_EQUALS(time, 2.5);
+		TS_ASSERT_EQUALS(h[0], 5);
+		TS_ASSERT_EQUALS(b[size-1], 5);
+	}
+
+	/**
+	 * Frames that were overwritten while reading are detected
+	 */
+	void testOverwritten(void) {
+		tools::LiveFeed feed(name, size, numFrames);
+		tools::LiveFeedReader reader(name);
+
+		fill(0);
+		feed.write(0, &values[0], &values[0], &values[0], size);
+
+		uint64_t seq;
+		double time;
+		const T *frame = reader.beginRead(0, seq, time);
+		TS_ASSERT(frame);
+		TS_ASSERT(reader.endRead(0, seq));
+
+		frame = reader.beginRead(0, seq, time);
+		for (unsigned int n = 1; n < numFrames+1; n++) {
+			fill(n);
+			feed.write(n, &values[0], &values[0], &values[0], size);
+		}
+		TS_ASSERT(!reader.endRead(0, seq));
+
+		// The slot holds frame numFrames now
+		TS_ASSERT(!reader.beginRead(0, seq, time));
+		TS_ASSERT(reader.beginRead(numFrames, seq, time));
+	}
+
+	/**
+	 * A reader never gets a partially written frame
+	 */
+	void testConcurrent(void) {
+		tools::LiveFeed feed(name, size, 2);
+		tools::LiveFeedReader reader(name);
+
+		const unsigned int writes = 20000;
+		std::thread writer(&LiveFeedTest::writeFrames, &feed, writes);
+
+		std::vector<T> h(size), hu(size), b(size);
+		unsigned int reads = 0, torn = 0;
+		int64_t number = -1;
+		while (number < static_cast<int64_t>(writes) - 1) {
+			double time;
+			number = reader.readLatest(time, &h[0], &hu[0], &b[0]);
+			if (number < 0)
+				continue;
+
+			reads++;
+			for (unsigned int i = 0; i < size; i++) {
+				if (h[i] != number || hu[i] != number || b[i] != number)
+					torn++;
+			}
+		}
+		writer.join();
+
+		TS_ASSERT_LESS_THAN(0u, reads);
+		TS_ASSERT_EQUALS(torn, 0u);
+	}
+
+	/**
+	 * Frames with a different number of cells are rejected
+	 */
+	void testSize(void) {
+		tools::LiveFeed feed(name, size, numFrames);
+
+		fill(0);
+		TS_ASSERT_THROWS(feed.write(0, &values[0], &values[0], &values[0], size-1), std::invalid_argument);
+	}
+
+	/**
+	 * A ring buffer needs at least one frame, on both sides
+	 */
+	void testNoFrames(void) {
+		TS_ASSERT_THROWS(tools::LiveFeed(name, size, 0), std::invalid_argument);
+
+		// Segment of another writer without frames
+		int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+		TS_ASSERT_LESS_THAN_EQUALS(0, fd);
+		TS_ASSERT_EQUALS(ftruncate(fd, sizeof(tools::LiveFeedLayout::Header)), 0);
+		void *segment = mmap(0L, sizeof(tools::LiveFeedLayout::Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		TS_ASSERT_DIFFERS(segment, MAP_FAILED);
+		tools::LiveFeedLayout::Header *header = static_cast<tools::LiveFeedLayout::Header*>(segment);
+		header->valueSize = sizeof(T);
+		header->numFrames = 0;
+		header->size = size;
+		header->magic = tools::LiveFeedLayout::magic;
+		munmap(segment, sizeof(tools::LiveFeedLayout::Header));
+
+		TS_ASSERT_THROWS(tools::LiveFeedReader reader(name), std::runtime_error);
+		shm_unlink(name);
+	}
+};
+
+#endif /* LIVEFEEDTEST_H_ */
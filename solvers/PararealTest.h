@@ -0,0 +1,149 @@
+/*
+ * PararealTest.h
+ *
+ *  Parallel-in-time integration.
+ */
+
+#ifndef PARAREALTEST_H_
+#define PARAREALTEST_H_
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Parareal.h"
+#include "../Scenario.h"
+#include "../WavePropagation.h"
+#include "../dambreak.h"
+#include "../tools/Boundary.h"
+
+class PararealTest : public CxxTest::TestSuite
+{
+private:
+	static const unsigned int size = 200;
+	static const unsigned int numSlices = 4;
+	static const T endTime;
+
+	std::vector<T> h, hu, b;
+	/** Fine solution, computed slice by slice */
+	std::vector<T> hFine, huFine;
+
+	/**
+	 * Computes the fine solution with the boundary conditions
+	 */
+	void fineSolution(const tools::Boundary &left, const tools::Boundary &right) {
+		hFine = h;
+		huFine = hu;
+		std::vector<T> bFine(b);
+		WavePropagation wavePropagation(&hFine[0], &huFine[0], &bFine[0], size, 1000. / size);
+		wavePropagation.setBoundary(tools::Boundary::Left, left);
+		wavePropagation.setBoundary(tools::Boundary::Right, right);
+		for (unsigned int s = 0; s < numSlices; s++) {
+			// Same time steps as the fine propagator of a slice
+			for (T t = 0; t < endTime / numSlices; ) {
+				wavePropagation.setBoundaryConditions(s * (endTime / numSlices) + t);
+				T dt = std::min(wavePropagation.computeNumericalFluxes(), endTime / numSlices - t);
+				wavePropagation.updateUnknowns(dt);
+				t += dt;
+			}
+		}
+	}
+
+public:
+	void setUp() {
+		scenarios::DamBreak scenario(size);
+		h.resize(size+2);
+		hu.resize(size+2);
+		b.resize(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		fineSolution(tools::Boundary::outflow(), tools::Boundary::outflow());
+	}
+
+	/**
+	 * One iteration per slice gives the fine solution (up to the
+	 * round-off of the correction)
+	 */
+	void testFineSolution(void) {
+		Parareal parareal(size, 1000. / size, numSlices);
+		parareal.setConvergence(0, numSlices);
+
+		TS_ASSERT_EQUALS(parareal.run(&h[0], &hu[0], &b[0], endTime), numSlices);
+		TS_ASSERT_EQUALS(parareal.getDefects().size(), numSlices);
+
+		for (unsigned int i = 1; i < size+1; i++) {
+			TS_ASSERT_DELTA(h[i], hFine[i], 1e-4);
+			TS_ASSERT_DELTA(hu[i], huFine[i], 1e-3);
+		}
+	}
+
+	/**
+	 * The iterations stop once the defect is below the tolerance
+	 */
+	void testConvergence(void) {
+		Parareal parareal(size, 1000. / size, numSlices);
+		parareal.setConvergence(0.02f, numSlices);
+
+		unsigned int iterations = parareal.run(&h[0], &hu[0], &b[0], endTime);
+		TS_ASSERT(parareal.converged());
+		TS_ASSERT_LESS_THAN(iterations, numSlices);
+		TS_ASSERT_EQUALS(parareal.getDefects().size(), iterations);
+		TS_ASSERT_LESS_THAN(parareal.getDefects().back(), 0.02f);
+
+		// The first iteration corrects the most
+		const std::vector<T> &defects = parareal.getDefects();
+		for (unsigned int k = 1; k < defects.size(); k++)
+			TS_ASSERT_LESS_THAN(defects[k], defects[0]);
+	}
+
+	/**
+	 * Both propagators use the boundary conditions at the simulated time
+	 * of the slice
+	 */
+	void testBoundaries(void) {
+		std::vector<T> times, discharges;
+		times.push_back(0);
+		discharges.push_back(0);
+		times.push_back(endTime);
+		discharges.push_back(50);
+		tools::Boundary left = tools::Boundary::hydrograph(times, discharges);
+
+		fineSolution(left, tools::Boundary::wall());
+
+		Parareal parareal(size, 1000. / size, numSlices);
+		parareal.setBoundary(tools::Boundary::Left, left);
+		parareal.setBoundary(tools::Boundary::Right, tools::Boundary::wall());
+		parareal.setConvergence(0, numSlices);
+		parareal.run(&h[0], &hu[0], &b[0], endTime);
+
+		// The inflow reached the first cells
+		TS_ASSERT_LESS_THAN(1, hu[1]);
+		for (unsigned int i = 1; i < size+1; i++) {
+			TS_ASSERT_DELTA(h[i], hFine[i], 1e-4);
+			TS_ASSERT_DELTA(hu[i], huFine[i], 1e-3);
+		}
+	}
+
+	/**
+	 * A dry domain has a defect of 0 (not NaN) and converges at once
+	 */
+	void testDry(void) {
+		std::fill(h.begin(), h.end(), 0);
+		std::fill(hu.begin(), hu.end(), 0);
+
+		Parareal parareal(size, 1000. / size, numSlices);
+		TS_ASSERT_EQUALS(parareal.run(&h[0], &hu[0], &b[0], endTime), 1u);
+		TS_ASSERT(parareal.converged());
+		TS_ASSERT_EQUALS(parareal.getDefects()[0], 0);
+
+		std::ostringstream report;
+		parareal.writeReport(report);
+		TS_ASSERT_EQUALS(report.str().find("nan"), std::string::npos);
+	}
+};
+
+const T PararealTest::endTime = 20;
+
+#endif /* PARAREALTEST_H_ */
@@ -0,0 +1,94 @@
+/*
+ * ReproducibleTest.h
+ *
+ *  Bitwise identical results for any number of threads.
+ */
+
+#ifndef REPRODUCIBLETEST_H_
+#define REPRODUCIBLETEST_H_
+
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Scenario.h"
+#include "../WavePropagation.h"
+#include "../dambreak.h"
+
+class ReproducibleTest : public CxxTest::TestSuite
+{
+private:
+	/** Number of cells (several reduction chunks) */
+	static const unsigned int size = 50000;
+
+	/**
+	 * Runs the dam break with the given number of threads
+	 *
+	 * @param residuals output, the residual of each time step
+	 * @return Mass at the end
+	 */
+	T run(int numThreads, bool dryBitmap, std::vector<T> &residuals) {
+#ifdef _OPENMP
+		int oldNumThreads = omp_get_max_threads();
+		omp_set_num_threads(numThreads);
+#endif
+
+		scenarios::DamBreak scenario(size);
+		std::vector<T> h(size+2), hu(size+2), b(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		wavePropagation.setReproducible(true);
+		wavePropagation.setDryBitmap(dryBitmap);
+
+		residuals.clear();
+		for (unsigned int n = 0; n < 100; n++) {
+			wavePropagation.setOutflowBoundaryConditions();
+			T dt = wavePropagation.computeNumericalFluxes();
+			wavePropagation.updateUnknowns(dt);
+			residuals.push_back(wavePropagation.getResidual());
+		}
+
+#ifdef _OPENMP
+		omp_set_num_threads(oldNumThreads);
+#endif
+		return wavePropagation.getMass();
+	}
+
+public:
+	/**
+	 * The residual and the mass do not depend on the number of threads
+	 */
+	void testThreads(void) {
+		for (int dryBitmap = 0; dryBitmap < 2; dryBitmap++) {
+			std::vector<T> expected, residuals;
+			T expectedMass = run(1, dryBitmap, expected);
+
+			for (int numThreads = 2; numThreads <= 5; numThreads++) {
+				T mass = run(numThreads, dryBitmap, residuals);
+
+				TS_ASSERT_EQUALS(mass, expectedMass);
+				TS_ASSERT_EQUALS(residuals.size(), expected.size());
+				for (unsigned int n = 0; n < residuals.size(); n++)
+					TS_ASSERT_EQUALS(residuals[n], expected[n]);
+			}
+		}
+	}
+
+	/**
+	 * The tree sum adds all values
+	 */
+	void testTreeSum(void) {
+		for (unsigned int n = 0; n < 20; n++) {
+			std::vector<int> values(n+1);
+			for (unsigned int i = 0; i < n; i++)
+				values[i] = i + 1;
+
+			TS_ASSERT_EQUALS(tools::treeSum(&values[0], n), static_cast<int>(n*(n+1)/2));
+		}
+	}
+};
+
+#endif /* REPRODUCIBLETEST_H_ */
@@ -0,0 +1,191 @@
+/*
+ * ResultCacheTest.h
+ *
+ *  Result cache of the Simulator.
+ */
+
+#ifndef RESULTCACHETEST_H_
+#define RESULTCACHETEST_H_
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Scenario.h"
+#include "../Simulator.h"
+#include "../WavePropagation.h"
+#include "../dambreak.h"
+#include "../tools/ResultCache.h"
+
+class ResultCacheTest : public CxxTest::TestSuite
+{
+private:
+	static const unsigned int size = 500;
+
+	std::vector<T> h, hu, b;
+	std::string directory;
+
+	/** Writer that keeps the heights of all checkpoints */
+	struct StoreWriter
+	{
+		std::vector<T> times;
+		std::vector<std::vector<T> > heights;
+
+		void write(T time, const T *h, const T*, const T*, unsigned int size)
+		{
+			times.push_back(time);
+			heights.push_back(std::vector<T>(h+1, h+size+1));
+		}
+	};
+
+	tools::ResultCache::Key key(const std::string &variant) const {
+		return tools::ResultCache::key(&h[0], &hu[0], &b[0], size, 1, variant);
+	}
+
+	/**
+	 * Runs the dam break from the initial state
+	 */
+	unsigned int run(T endTime, StoreWriter &writer, unsigned long &steps) {
+		setUp();
+		tools::ResultCache cache(directory);
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, 1);
+		Simulator<StoreWriter> simulator(wavePropagation, writer);
+		simulator.enableCache(cache, key("fwave"));
+		simulator.run(endTime, 5);
+		steps = simulator.getSteps();
+		return simulator.getCacheHits();
+	}
+
+public:
+	void setUp() {
+		scenarios::DamBreak scenario(size);
+		h.resize(size+2);
+		hu.resize(size+2);
+		b.resize(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		if (directory.empty()) {
+			char name[] = "/tmp/swe1d-cache-XXXXXX";
+			TS_ASSERT(mkdtemp(name));
+			directory = name;
+		}
+	}
+
+	void tearDown() {
+		std::system(("rm -rf " + directory).c_str());
+		directory.clear();
+	}
+
+	/**
+	 * The key depends on the variant and on the initial state
+	 */
+	void testKey(void) {
+		std::string original = key("fwave").str();
+		TS_ASSERT_EQUALS(original, key("fwave").str());
+		TS_ASSERT_DIFFERS(original, key("hybrid").str());
+
+		h[size/2] += 1;
+		TS_ASSERT_DIFFERS(original, key("fwave").str());
+	}
+
+	/**
+	 * The key of an engine includes the configuration and the tracers
+	 */
+	void testEngineKey(void) {
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, 1);
+		std::string original = tools::ResultCache::key(wavePropagation).str();
+		TS_ASSERT_EQUALS(original, tools::ResultCache::key(wavePropagation).str());
+		TS_ASSERT_DIFFERS(original, tools::ResultCache::key(wavePropagation, "steady").str());
+
+		wavePropagation.setKernel(WavePropagation::KernelHybrid);
+		std::string hybrid = tools::ResultCache::key(wavePropagation).str();
+		TS_ASSERT_DIFFERS(original, hybrid);
+
+		wavePropagation.setCflNumber(0.5);
+		std::string cfl = tools::ResultCache::key(wavePropagation).str();
+		TS_ASSERT_DIFFERS(hybrid, cfl);
+
+		wavePropagation.setBoundary(tools::Boundary::Right, tools::Boundary::inflow(1));
+		std::string inflow = tools::ResultCache::key(wavePropagation).str();
+		TS_ASSERT_DIFFERS(cfl, inflow);
+		wavePropagation.setBoundary(tools::Boundary::Right, tools::Boundary::inflow(2));
+		TS_ASSERT_DIFFERS(inflow, tools::ResultCache::key(wavePropagation).str());
+
+		std::vector<T> c(size+2, 0);
+		wavePropagation.setTracers(&c[0], 1);
+		std::string tracer = tools::ResultCache::key(wavePropagation).str();
+		c[size/2] = 1;
+		TS_ASSERT_DIFFERS(tracer, tools::ResultCache::key(wavePropagation).str());
+	}
+
+	/**
+	 * A resumed run continues with the cached tracers
+	 */
+	void testTracers(void) {
+		StoreWriter writer;
+		std::vector<T> c(size+2, 0), cFirst;
+		for (unsigned int i = size/4; i < size/2; i++)
+			c[i] = 1;
+		const std::vector<T> initialC = c;
+
+		for (unsigned int run = 0; run < 2; run++) {
+			setUp();
+			c = initialC;
+			tools::ResultCache cache(directory);
+			WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, 1);
+			wavePropagation.setTracers(&c[0], 1);
+			Simulator<StoreWriter> simulator(wavePropagation, writer);
+			simulator.enableCache(cache, tools::ResultCache::key(wavePropagation));
+			simulator.run(10, 2);
+
+			if (run == 0) {
+				TS_ASSERT_EQUALS(simulator.getCacheHits(), 0u);
+				cFirst = c;
+			} else {
+				TS_ASSERT_EQUALS(simulator.getCacheHits(), 2u);
+			}
+		}
+
+		TS_ASSERT(c != initialC);
+		TS_ASSERT(c == cFirst);
+	}
+
+	/**
+	 * The same configuration again only loads the checkpoints
+	 */
+	void testReplay(void) {
+		StoreWriter computed, cached;
+		unsigned long computedSteps, cachedSteps;
+		TS_ASSERT_EQUALS(run(10, computed, computedSteps), 0u);
+		TS_ASSERT_EQUALS(run(10, cached, cachedSteps), 5u);
+
+		TS_ASSERT_EQUALS(cachedSteps, computedSteps);
+		TS_ASSERT_EQUALS(cached.times, computed.times);
+		TS_ASSERT_EQUALS(cached.heights, computed.heights);
+	}
+
+	/**
+	 * A larger end time continues from the last cached checkpoint
+	 */
+	void testResume(void) {
+		StoreWriter first, resumed, reference;
+		unsigned long steps, resumedSteps;
+		run(10, first, steps);
+		// Checkpoints 4 and 8 are cached, 12 continues from 10
+		TS_ASSERT_EQUALS(run(20, resumed, resumedSteps), 3u);
+
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, 1);
+		setUp();
+		Simulator<StoreWriter> simulator(wavePropagation, reference);
+		simulator.run(20, 5);
+
+		TS_ASSERT_EQUALS(resumed.times, reference.times);
+		for (unsigned int i = 0; i < size; i++)
+			TS_ASSERT_DELTA(resumed.heights.back()[i], reference.heights.back()[i], 1e-3);
+	}
+};
+
+#endif /* RESULTCACHETEST_H_ */
@@ -0,0 +1,75 @@
+/*
+ * ScenarioTest.h
+ *
+ *  Parallel initialization of the unknowns from a scenario.
+ */
+
+#ifndef SCENARIOTEST_H_
+#define SCENARIOTEST_H_
+
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Scenario.h"
+#include "../SubCriticalFlow.h"
+#include "../dambreak.h"
+
+class ScenarioTest : public CxxTest::TestSuite
+{
+private:
+	static const unsigned int size = 5000;
+
+	/**
+	 * Initializes the cells [offset, offset + localSize) and compares
+	 * them with the whole domain
+	 */
+	template<class Scenario>
+	void checkSlab(Scenario &scenario, unsigned int offset, unsigned int localSize) {
+		std::vector<T> h(size+2), hu(size+2), b(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		std::vector<T> hSlab(localSize+2), huSlab(localSize+2), bSlab(localSize+2);
+		scenarios::init(scenario, &hSlab[0], &huSlab[0], &bSlab[0], localSize, offset);
+
+		for (unsigned int i = 1; i < localSize+1; i++) {
+			TS_ASSERT_EQUALS(hSlab[i], h[offset+i]);
+			TS_ASSERT_EQUALS(huSlab[i], hu[offset+i]);
+			TS_ASSERT_EQUALS(bSlab[i], b[offset+i]);
+		}
+
+		// Ghost cells
+		TS_ASSERT_EQUALS(hSlab[0], 0);
+		TS_ASSERT_EQUALS(hSlab[localSize+1], 0);
+	}
+
+public:
+	/**
+	 * The whole domain is filled with the values of the scenario
+	 */
+	void testInit(void) {
+		scenarios::SubCriticalFlow scenario(size);
+		std::vector<T> h(size+2), hu(size+2), b(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		for (unsigned int i = 0; i < size; i++) {
+			TS_ASSERT_EQUALS(b[i+1], scenario.getBathymetry(i));
+			TS_ASSERT_EQUALS(h[i+1], -b[i+1]);
+		}
+	}
+
+	/**
+	 * Slabs (see DistributedWavePropagation) get the cells at their
+	 * global index
+	 */
+	void testOffset(void) {
+		scenarios::DamBreak damBreak(size);
+		checkSlab(damBreak, 0, size/3);
+		checkSlab(damBreak, size/3, size/3);
+		checkSlab(damBreak, size - 7, 7);
+
+		scenarios::SubCriticalFlow subCritical(size);
+		checkSlab(subCritical, 1234, 2000);
+	}
+};
+
+#endif /* SCENARIOTEST_H_ */
@@ -0,0 +1,129 @@
+/*
+ * SteadyStateTest.h
+ *
+ *  Steady state detection and its use in the Simulator.
+ */
+
+#ifndef STEADYSTATETEST_H_
+#define STEADYSTATETEST_H_
+
+#include <limits>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Scenario.h"
+#include "../Simulator.h"
+#include "../SubCriticalFlow.h"
+#include "../WavePropagation.h"
+#include "../tools/SteadyState.h"
+
+class SteadyStateTest : public CxxTest::TestSuite
+{
+private:
+	/** Enough cells to resolve the bump between 8 m and 12 m */
+	static const unsigned int size = 1000;
+
+	std::vector<T> h, hu, b;
+
+	/** Writer that only counts the checkpoints */
+	struct NullWriter
+	{
+		unsigned int count;
+
+		NullWriter() : count(0) {}
+
+		void write(T, const T*, const T*, const T*, unsigned int)
+		{
+			count++;
+		}
+	};
+
+public:
+	void setUp() {
+		scenarios::SubCriticalFlow scenario(size);
+		h.resize(size+2);
+		hu.resize(size+2);
+		b.resize(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+	}
+
+	/**
+	 * The flow is steady after window residuals below the tolerance
+	 */
+	void testWindow(void) {
+		tools::SteadyState steadyState(1e-3, 3);
+
+		TS_ASSERT(!steadyState.update(1e-4));
+		TS_ASSERT(!steadyState.update(1e-4));
+		// Starts over
+		TS_ASSERT(!steadyState.update(1e-2));
+		TS_ASSERT(!steadyState.update(1e-4));
+		TS_ASSERT(!steadyState.update(1e-4));
+		TS_ASSERT(steadyState.update(1e-4));
+		TS_ASSERT(steadyState.isSteady());
+
+		steadyState.reset();
+		TS_ASSERT(!steadyState.isSteady());
+	}
+
+	/**
+	 * NaN never counts as steady
+	 */
+	void testNaN(void) {
+		tools::SteadyState steadyState(1e-3, 2);
+
+		steadyState.update(1e-4);
+		TS_ASSERT(!steadyState.update(std::numeric_limits<T>::quiet_NaN()));
+		TS_ASSERT(!steadyState.update(1e-4));
+		TS_ASSERT(steadyState.update(1e-4));
+	}
+
+	/**
+	 * The subcritical flow over the bump becomes steady and stops the
+	 * simulation early
+	 */
+	void testStop(void) {
+		scenarios::SubCriticalFlow scenario(size);
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		wavePropagation.setBoundary(tools::Boundary::Left, scenario.getBoundary(tools::Boundary::Left));
+		wavePropagation.setBoundary(tools::Boundary::Right, scenario.getBoundary(tools::Boundary::Right));
+
+		NullWriter writer;
+		Simulator<NullWriter> simulator(wavePropagation, writer);
+		simulator.enableSteadyState(scenario.getSteadyStateTolerance(), scenario.getSteadyStateWindow());
+
+		T time = simulator.run(1000, 10);
+		TS_ASSERT(simulator.isSteady());
+		TS_ASSERT_LESS_THAN(time, 1000);
+		// The initial state is not steady
+		TS_ASSERT_LESS_THAN(scenario.getSteadyStateWindow(), simulator.getSteps());
+		// Initial state, the checkpoints before and the steady state
+		TS_ASSERT_LESS_THAN(2u, writer.count);
+		TS_ASSERT_LESS_THAN(writer.count, 11u);
+	}
+
+	/**
+	 * SteadyReduceOutput continues, but skips checkpoints
+	 */
+	void testReduceOutput(void) {
+		scenarios::SubCriticalFlow scenario(size);
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		wavePropagation.setBoundary(tools::Boundary::Left, scenario.getBoundary(tools::Boundary::Left));
+		wavePropagation.setBoundary(tools::Boundary::Right, scenario.getBoundary(tools::Boundary::Right));
+
+		NullWriter writer;
+		Simulator<NullWriter> simulator(wavePropagation, writer);
+		simulator.enableSteadyState(scenario.getSteadyStateTolerance(), scenario.getSteadyStateWindow(),
+			Simulator<NullWriter>::SteadyReduceOutput, 5);
+
+		TS_ASSERT_EQUALS(simulator.run(1000, 20), 1000);
+		TS_ASSERT(simulator.isSteady());
+		TS_ASSERT_LESS_THAN(scenario.getSteadyStateWindow(), simulator.getSteps());
+		// Initial state, the checkpoints until the flow is steady (after
+		// about 165 s), then every 5th
+		TS_ASSERT_LESS_THAN(writer.count, 10u);
+		TS_ASSERT_LESS_THAN_EQUALS(5u, writer.count);
+	}
+};
+
+#endif /* STEADYSTATETEST_H_ */
@@ -0,0 +1,126 @@
+/*
+ * TracerTest.h
+ *
+ *  Passive tracer transport in WavePropagation.
+ */
+
+#ifndef TRACERTEST_H_
+#define TRACERTEST_H_
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Scenario.h"
+#include "../WavePropagation.h"
+#include "../dambreak.h"
+
+class TracerTest : public CxxTest::TestSuite
+{
+private:
+	/** Number of cells */
+	static const unsigned int size = 1000;
+
+	std::vector<T> h, hu, b;
+	/** Two tracers */
+	std::vector<T> c;
+
+	/**
+	 * Runs the dam break with the tracers for the given number of steps
+	 */
+	void run(unsigned int steps) {
+		scenarios::DamBreak scenario(size);
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		wavePropagation.setTracers(&c[0], 2);
+
+		run(wavePropagation, steps);
+	}
+
+	static void run(WavePropagation &wavePropagation, unsigned int steps) {
+		for (unsigned int n = 0; n < steps; n++) {
+			wavePropagation.setOutflowBoundaryConditions();
+			T dt = wavePropagation.computeNumericalFluxes();
+			wavePropagation.updateUnknowns(dt);
+		}
+	}
+
+	/**
+	 * @return Tracer mass of tracer k
+	 */
+	T mass(unsigned int k) {
+		T sum = 0;
+		for (unsigned int i = 1; i < size+1; i++)
+			sum += h[i] * c[k*(size+2) + i];
+		return sum;
+	}
+
+public:
+	void setUp() {
+		scenarios::DamBreak scenario(size);
+		h.resize(size+2);
+		hu.resize(size+2);
+		b.resize(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		c.assign(2*(size+2), 0);
+		for (unsigned int i = 1; i < size+1; i++) {
+			// Constant
+			c[i] = 1;
+			// Patch across the dam
+			c[size+2 + i] = (i > 400 && i < 600) ? 1 : 0;
+		}
+	}
+
+	/**
+	 * A constant concentration stays constant
+	 */
+	void testConstant(void) {
+		run(200);
+
+		for (unsigned int i = 1; i < size+1; i++)
+			TS_ASSERT_DELTA(c[i], 1.0f, 0.0001f);
+	}
+
+	/**
+	 * The tracer mass is conserved and the concentration stays in [0, 1]
+	 */
+	void testConservation(void) {
+		T initialMass = mass(1);
+
+		// The waves do not reach the boundaries
+		run(200);
+
+		TS_ASSERT_DELTA(mass(1) / initialMass, 1.0f, 0.0001f);
+		for (unsigned int i = 1; i < size+1; i++) {
+			TS_ASSERT_LESS_THAN_EQUALS(-0.0001f, c[size+2 + i]);
+			TS_ASSERT_LESS_THAN_EQUALS(c[size+2 + i], 1.0001f);
+		}
+	}
+
+	/**
+	 * setState() restores the tracers with the unknowns
+	 */
+	void testState(void) {
+		scenarios::DamBreak scenario(size);
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		wavePropagation.setTracers(&c[0], 2);
+
+		std::vector<T> state;
+		wavePropagation.getState(state);
+		std::vector<T> initialH = h, initialC = c;
+
+		run(wavePropagation, 50);
+		TS_ASSERT(c != initialC);
+
+		wavePropagation.setState(state);
+		TS_ASSERT(h == initialH);
+		TS_ASSERT(c == initialC);
+
+		// Saved with a different number of tracers
+		wavePropagation.setTracers(&c[0], 1);
+		TS_ASSERT_THROWS(wavePropagation.setState(state), std::invalid_argument);
+	}
+};
+
+#endif /* TRACERTEST_H_ */
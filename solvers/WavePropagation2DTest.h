@@ -0,0 +1,161 @@
+/*
+ * WavePropagation2DTest.h
+ *
+ *  Compares the sweeps of WavePropagation2D with the 1D engine.
+ */
+
+#ifndef WAVEPROPAGATION2DTEST_H_
+#define WAVEPROPAGATION2DTEST_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+#include "../../TsunamiOriginal/SWE1D/src/types.h"
+#include "../Scenario.h"
+#include "../WavePropagation.h"
+#include "../WavePropagation2D.h"
+#include "../dambreak.h"
+
+class WavePropagation2DTest : public CxxTest::TestSuite
+{
+private:
+	/** Number of cells in the direction of the dam break */
+	static const unsigned int size = 100;
+	/** Number of cells in the other direction */
+	static const unsigned int width = 37;
+	/** Number of time steps */
+	static const unsigned int steps = 50;
+
+	/**
+	 * Runs the dam break along x (alongX) or y in 2D and in 1D with the
+	 * time steps of the 1D engine and compares all rows (columns).
+	 */
+	void compare(bool alongX, unsigned int tileWidth, unsigned int tileHeight) {
+		scenarios::DamBreak scenario(size);
+
+		std::vector<T> h(size+2), hu(size+2), b(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		unsigned int nx = alongX ? size : width;
+		unsigned int ny = alongX ? width : size;
+		std::vector<T> h2((nx+2)*(ny+2)), hu2((nx+2)*(ny+2)), hv2((nx+2)*(ny+2)), b2((nx+2)*(ny+2));
+		for (unsigned int j = 0; j < ny+2; j++) {
+			for (unsigned int i = 0; i < nx+2; i++) {
+				unsigned int pos = alongX ? i : j;
+				h2[j*(nx+2)+i] = h[pos];
+				b2[j*(nx+2)+i] = b[pos];
+				(alongX ? hu2 : hv2)[j*(nx+2)+i] = hu[pos];
+			}
+		}
+
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		WavePropagation2D wavePropagation2D(&h2[0], &hu2[0], &hv2[0], &b2[0], nx, ny,
+			scenario.getCellSize(), scenario.getCellSize());
+		wavePropagation2D.setTileSize(tileWidth, tileHeight);
+
+		for (unsigned int n = 0; n < steps; n++) {
+			wavePropagation.setOutflowBoundaryConditions();
+			T dt = wavePropagation.computeNumericalFluxes();
+			wavePropagation.updateUnknowns(dt);
+
+			wavePropagation2D.setOutflowBoundaryConditions();
+			wavePropagation2D.computeNumericalFluxes();
+			wavePropagation2D.updateUnknowns(dt);
+		}
+
+		const std::vector<T> &momentum2D = alongX ? hu2 : hv2;
+		for (unsigned int j = 1; j < ny+1; j++) {
+			for (unsigned int i = 1; i < nx+1; i++) {
+				unsigned int pos = alongX ? i : j;
+				TS_ASSERT_DELTA(h2[j*(nx+2)+i], h[pos], 0.0001f);
+				TS_ASSERT_DELTA(momentum2D[j*(nx+2)+i], hu[pos], 0.0001f);
+			}
+		}
+	}
+
+public:
+	void testDamBreakX(void) {
+		compare(true, 32, 64);
+	}
+
+	void testDamBreakY(void) {
+		compare(false, 32, 64);
+	}
+
+	/**
+	 * Tiles that do not divide the grid
+	 */
+	void testDamBreakYSmallTiles(void) {
+		compare(false, 5, 7);
+	}
+
+	/**
+	 * Columns gathered one by one
+	 */
+	void testDamBreakYStrided(void) {
+		compare(false, 1, 64);
+	}
+
+	/**
+	 * The time step scales with the CFL number like in 1D
+	 */
+	void testCflNumber(void) {
+		scenarios::DamBreak scenario(size);
+		std::vector<T> h(size+2), hu(size+2), b(size+2);
+		scenarios::init(scenario, &h[0], &hu[0], &b[0], size);
+
+		std::vector<T> h2((size+2)*(width+2)), hu2((size+2)*(width+2)),
+			hv2((size+2)*(width+2)), b2((size+2)*(width+2));
+		for (unsigned int j = 0; j < width+2; j++) {
+			std::copy(h.begin(), h.end(), h2.begin() + j*(size+2));
+			std::copy(b.begin(), b.end(), b2.begin() + j*(size+2));
+		}
+
+		WavePropagation wavePropagation(&h[0], &hu[0], &b[0], size, scenario.getCellSize());
+		WavePropagation2D wavePropagation2D(&h2[0], &hu2[0], &hv2[0], &b2[0], size, width,
+			scenario.getCellSize(), scenario.getCellSize());
+		wavePropagation.setCflNumber(0.8f);
+		wavePropagation2D.setCflNumber(0.8f);
+		TS_ASSERT_EQUALS(wavePropagation2D.getCflNumber(), 0.8f);
+
+		wavePropagation.setOutflowBoundaryConditions();
+		wavePropagation2D.setOutflowBoundaryConditions();
+		TS_ASSERT_DELTA(wavePropagation2D.computeNumericalFluxes(),
+			wavePropagation.computeNumericalFluxes(), 1e-5f);
+	}
+
+	/**
+	 * The time step respects the wave speeds in y direction of the current
+	 * state, also in the first step and when v dominates u
+	 */
+	void testFastFlowY(void) {
+		const unsigned int nx = 4, ny = 200;
+		std::vector<T> h((nx+2)*(ny+2)), hu((nx+2)*(ny+2)), hv((nx+2)*(ny+2)), b((nx+2)*(ny+2));
+		for (unsigned int j = 0; j < ny+2; j++) {
+			for (unsigned int i = 0; i < nx+2; i++) {
+				h[j*(nx+2)+i] = j < ny/2 ? 0.2f : 2.0f;
+				hv[j*(nx+2)+i] = 15 * h[j*(nx+2)+i];
+			}
+		}
+
+		WavePropagation2D wavePropagation2D(&h[0], &hu[0], &hv[0], &b[0], nx, ny, 1, 1);
+
+		for (unsigned int n = 0; n < steps; n++) {
+			wavePropagation2D.setOutflowBoundaryConditions();
+
+			T maxWaveSpeedY = 0;
+			for (unsigned int k = 0; k < h.size(); k++)
+				maxWaveSpeedY = std::max(maxWaveSpeedY, std::fabs(hv[k] / h[k])
+					+ std::sqrt(solver::FWave<T>::g * h[k]));
+
+			T dt = wavePropagation2D.computeNumericalFluxes();
+			TS_ASSERT_LESS_THAN_EQUALS(dt * maxWaveSpeedY, wavePropagation2D.getCflNumber() * 1.0001f);
+			wavePropagation2D.updateUnknowns(dt);
+
+			TS_ASSERT_LESS_THAN_EQUALS(0, *std::min_element(h.begin(), h.end()));
+		}
+	}
+};
+
+#endif /* WAVEPROPAGATION2DTEST_H_ */
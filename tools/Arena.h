@@ -0,0 +1,175 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Single memory region for all arrays of a simulation.
+ *
+ *  The memory is mapped but not touched. Pages are placed on the NUMA node
+ *  of the thread that writes them first, so arrays should be initialized
+ *  in the same static partition they are computed in (see
+ *  scenarios::init() and firstTouch()).
+ */
+
+#ifndef TOOLS_ARENA_H_
+#define TOOLS_ARENA_H_
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+#include <sys/mman.h>
+
+#include "Partition.h"
+
+namespace tools
+{
+
+class Arena
+{
+public:
+	enum HugePages {
+		/** Regular pages */
+		NoHugePages,
+		/** Ask for transparent huge pages (madvise) */
+		TransparentHugePages,
+		/** Use reserved huge pages (MAP_HUGETLB), transparent huge pages if none are available */
+		ExplicitHugePages
+	};
+
+	/** Alignment of all arrays (cache line, widest SIMD register) */
+	static const size_t alignment = 64;
+
+	/** Size of a huge page */
+	static const size_t hugePageSize = 2 * 1024 * 1024;
+
+private:
+	char *m_memory;
+	/** Mapped size in bytes */
+	size_t m_capacity;
+	/** Used bytes */
+	size_t m_used;
+	/** Huge pages actually used */
+	HugePages m_hugePages;
+
+public:
+	/**
+	 * @param capacity size in bytes, see bytes()
+	 * @param hugePages kind of huge pages
+	 */
+	Arena(size_t capacity, HugePages hugePages = TransparentHugePages)
+		: m_memory(0L), m_capacity(capacity), m_used(0), m_hugePages(hugePages)
+	{
+		if (hugePages != NoHugePages)
+			m_capacity = (m_capacity + hugePageSize - 1) / hugePageSize * hugePageSize;
+
+		void *memory = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+		if (hugePages == ExplicitHugePages) {
+			// Without MAP_NORESERVE, fails if not enough pages are reserved
+			memory = mmap(0L, m_capacity, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (memory == MAP_FAILED)
+				// No reserved huge pages
+				m_hugePages = TransparentHugePages;
+		}
+#else
+		if (m_hugePages == ExplicitHugePages)
+			m_hugePages = TransparentHugePages;
+#endif
+
+		if (memory == MAP_FAILED) {
+			memory = mmap(0L, m_capacity, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (memory == MAP_FAILED)
+				throw std::bad_alloc();
+
+#ifdef MADV_HUGEPAGE
+			if (m_hugePages == TransparentHugePages)
+				madvise(memory, m_capacity, MADV_HUGEPAGE);
+#else
+			m_hugePages = NoHugePages;
+#endif
+		}
+
+		m_memory = static_cast<char*>(memory);
+	}
+
+	/**
+	 * Releases all arrays at once
+	 */
+	~Arena()
+	{
+		munmap(m_memory, m_capacity);
+	}
+
+	/**
+	 * @param count number of elements
+	 * @return Aligned array (not initialized)
+	 */
+	template<typename V>
+	V* allocate(size_t count)
+	{
+		size_t size = bytes<V>(count);
+		if (m_used + size > m_capacity)
+			throw std::bad_alloc();
+
+		V *array = reinterpret_cast<V*>(m_memory + m_used);
+		m_used += size;
+		return array;
+	}
+
+	/**
+	 * @return Bytes required in the arena for an array of count elements
+	 */
+	template<typename V>
+	static size_t bytes(size_t count)
+	{
+		return (count * sizeof(V) + alignment - 1) / alignment * alignment;
+	}
+
+	/**
+	 * Sets an array to zero, each OpenMP thread its static range of
+	 * [offset, offset + size). Use this for arrays that are not
+	 * initialized by a scenario.
+	 */
+	template<typename V>
+	static void firstTouch(V *array, size_t size, size_t offset = 0)
+	{
+#ifdef _OPENMP
+		#pragma omp parallel
+#endif
+		{
+			unsigned int begin, end;
+			staticRange(size, begin, end);
+			memset(array + offset + begin, 0, (end - begin) * sizeof(V));
+		}
+	}
+
+	size_t capacity() const
+	{
+		return m_capacity;
+	}
+
+	size_t used() const
+	{
+		return m_used;
+	}
+
+	/**
+	 * @return The kind of huge pages used (may be less than requested)
+	 */
+	HugePages hugePages() const
+	{
+		return m_hugePages;
+	}
+
+private:
+	// Not copyable
+	Arena(const Arena&);
+	Arena& operator=(const Arena&);
+};
+
+}
+
+#endif /* TOOLS_ARENA_H_ */
@@ -0,0 +1,223 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Boundary conditions. They only fill the ghost cells before the edge
+ *  sweep, so the sweep itself treats all edges the same way.
+ */
+
+#ifndef TOOLS_BOUNDARY_H_
+#define TOOLS_BOUNDARY_H_
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+namespace tools
+{
+
+class Boundary
+{
+public:
+	enum Type {
+		/** Zero gradient, waves leave the domain */
+		Outflow,
+		/** Reflecting wall, the momentum is mirrored */
+		Wall,
+		/** Fixed discharge into the domain */
+		Inflow,
+		/** Discharge into the domain interpolated from a table */
+		Hydrograph
+	};
+
+	enum Side {
+		Left,
+		Right
+	};
+
+private:
+	Type m_type;
+	/** Discharge (Inflow) */
+	T m_discharge;
+
+	/** Times (ascending) and discharges of the hydrograph */
+	std::vector<T> m_times;
+	std::vector<T> m_discharges;
+	/** Interval of the last lookup: m_times[m_interval] <= time < m_times[m_interval+1] */
+	unsigned int m_interval;
+
+	Boundary(Type type, T discharge = 0)
+		: m_type(type), m_discharge(discharge), m_interval(0)
+	{
+	}
+
+public:
+	/**
+	 * Outflow (default)
+	 */
+	Boundary()
+		: m_type(Outflow), m_discharge(0), m_interval(0)
+	{
+	}
+
+	static Boundary outflow()
+	{
+		return Boundary(Outflow);
+	}
+
+	static Boundary wall()
+	{
+		return Boundary(Wall);
+	}
+
+	/**
+	 * @param discharge discharge (hu) into the domain, negative values
+	 *  leave the domain
+	 */
+	static Boundary inflow(T discharge)
+	{
+		return Boundary(Inflow, discharge);
+	}
+
+	/**
+	 * Piecewise linear discharge into the domain. Before the first and
+	 * after the last time, the first or last discharge is used.
+	 *
+	 * @param times ascending times
+	 * @param discharges discharge at each time
+	 */
+	static Boundary hydrograph(const std::vector<T> &times, const std::vector<T> &discharges)
+	{
+		if (times.empty() || times.size() != discharges.size())
+			throw std::invalid_argument("Hydrograph needs the same (non-zero) number of times and discharges");
+		for (unsigned int i = 1; i < times.size(); i++) {
+			if (!(times[i-1] < times[i]))
+				throw std::invalid_argument("Hydrograph times have to be ascending");
+		}
+
+		Boundary boundary(Hydrograph);
+		boundary.m_times = times;
+		boundary.m_discharges = discharges;
+		return boundary;
+	}
+
+	/**
+	 * Reads a hydrograph from a text file with one "time discharge" pair
+	 * per line
+	 */
+	static Boundary hydrograph(const char* filename)
+	{
+		std::ifstream in(filename);
+		if (!in)
+			throw std::runtime_error(std::string("Could not open ") + filename);
+
+		std::vector<T> times, discharges;
+		T time, discharge;
+		while (in >> time >> discharge) {
+			times.push_back(time);
+			discharges.push_back(discharge);
+		}
+		if (!in.eof())
+			throw std::runtime_error(std::string("Could not parse ") + filename);
+
+		return hydrograph(times, discharges);
+	}
+
+	Type getType() const
+	{
+		return m_type;
+	}
+
+	/**
+	 * @return Discharge of Inflow
+	 */
+	T getDischarge() const
+	{
+		return m_discharge;
+	}
+
+	/**
+	 * @return Times of the Hydrograph
+	 */
+	const std::vector<T>& getTimes() const
+	{
+		return m_times;
+	}
+
+	/**
+	 * @return Discharges of the Hydrograph
+	 */
+	const std::vector<T>& getDischarges() const
+	{
+		return m_discharges;
+	}
+
+	/**
+	 * Fills the ghost cell on one side
+	 *
+	 * @param time simulated time
+	 * @param h water heights, size + 2 (incl. ghost cells)
+	 * @param hu momentums, size + 2
+	 * @param b bathymetry, size + 2
+	 * @param size number of cells
+	 */
+	void apply(T time, T *h, T *hu, T *b, unsigned int size, Side side)
+	{
+		unsigned int ghost = (side == Left ? 0 : size+1);
+		unsigned int inner = (side == Left ? 1 : size);
+		// Positive discharges flow into the domain
+		T sign = (side == Left ? 1 : -1);
+
+		h[ghost] = h[inner];
+		b[ghost] = b[inner];
+
+		switch (m_type) {
+		case Outflow:
+			hu[ghost] = hu[inner];
+			break;
+		case Wall:
+			hu[ghost] = -hu[inner];
+			break;
+		case Inflow:
+			hu[ghost] = sign * m_discharge;
+			break;
+		case Hydrograph:
+			hu[ghost] = sign * discharge(time);
+			break;
+		}
+	}
+
+	/**
+	 * @return Discharge of the hydrograph at time. Amortized O(1) for
+	 *  increasing times (the interval is kept from the last call), also
+	 *  works after a rollback.
+	 */
+	T discharge(T time)
+	{
+		if (m_type == Inflow)
+			return m_discharge;
+		if (m_type != Hydrograph)
+			return 0;
+
+		const unsigned int last = m_times.size() - 1;
+		while (m_interval < last && time >= m_times[m_interval+1])
+			m_interval++;
+		while (m_interval > 0 && time < m_times[m_interval])
+			m_interval--;
+
+		if (time <= m_times[0])
+			return m_discharges[0];
+		if (m_interval == last)
+			return m_discharges[last];
+
+		T alpha = (time - m_times[m_interval]) / (m_times[m_interval+1] - m_times[m_interval]);
+		return m_discharges[m_interval] + alpha * (m_discharges[m_interval+1] - m_discharges[m_interval]);
+	}
+};
+
+}
+
+#endif /* TOOLS_BOUNDARY_H_ */
@@ -0,0 +1,676 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Bulk output of full snapshots that bypasses the page cache.
+ *
+ *  DirectWriter is a writer for Simulator. write() copies h, hu and b
+ *  into a free, page aligned buffer and submits it with io_uring. The
+ *  file is opened with O_DIRECT, so the data goes from the buffer to the
+ *  device by DMA. Several writes are in flight at the same time, and a
+ *  buffer is reused only after its write has completed. If io_uring is
+ *  not available (old kernel, seccomp), the buffers are written with
+ *  pwrite() instead, and without O_DIRECT if the file system does not
+ *  support it (e.g. tmpfs).
+ *
+ *  File format: one record of recordBytes(size, pyramidFactor) bytes per
+ *  snapshot (a multiple of 4096). Each record starts with a Header (64
+ *  bytes), followed by h, hu and b (size values each, without ghost
+ *  cells). Snapshot n is at offset n * recordBytes(size, pyramidFactor).
+ *
+ *  With a pyramid factor f > 1, the record also contains a min/max/mean
+ *  pyramid of h, hu and the surface elevation h + b for zoomed out views.
+ *  Level 1 summarizes f cells, level l + 1 summarizes f cells of level l,
+ *  up to the level with a single cell. Each level starts at a multiple of
+ *  4096 (pyramidOffset()) and stores one PyramidCell per cell, so any
+ *  window of a level is one contiguous read (see readPyramid()). Level 1
+ *  is computed in the same pass as the copy of the snapshot.
+ */
+
+#ifndef TOOLS_DIRECTWRITER_H_
+#define TOOLS_DIRECTWRITER_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#endif
+
+#include "types.h"
+#include "Tracer.h"
+
+namespace tools
+{
+
+class DirectWriter
+{
+public:
+	/** Alignment of the buffers, the records and the transfer sizes */
+	static const size_t alignment = 4096;
+	/** Largest single io_uring write (the length has 32 bits) */
+	static const size_t maxChunkBytes = 1 << 30;
+
+	struct alignas(64) Header
+	{
+		/** "SWE1DRCT" */
+		char magic[8];
+		/** sizeof(T) */
+		uint32_t valueSize;
+		/** Number of cells */
+		uint32_t size;
+		/** Number of the snapshot */
+		uint64_t number;
+		/** Simulated time */
+		double time;
+		/** Cells of the previous level per pyramid cell, 0 without pyramid */
+		uint32_t pyramidFactor;
+		/** Number of pyramid levels */
+		uint32_t pyramidLevels;
+	};
+
+	struct Summary
+	{
+		T min;
+		T max;
+		T mean;
+	};
+
+	/** Summary of a range of cells */
+	struct PyramidCell
+	{
+		Summary h;
+		Summary hu;
+		/** Surface elevation h + b */
+		Summary eta;
+	};
+
+private:
+	int m_fd;
+	/** True if the file was opened with O_DIRECT */
+	bool m_direct;
+
+	const unsigned int m_size;
+	/** Cells of the previous level per pyramid cell, 0 without pyramid */
+	const unsigned int m_pyramidFactor;
+	const unsigned int m_pyramidLevels;
+	const size_t m_recordBytes;
+
+	/** Page aligned snapshot buffers */
+	std::vector<char*> m_buffers;
+	/** Indices of the buffers that can be filled */
+	std::vector<unsigned int> m_free;
+	/** Writes of each record (io_uring writes of at most maxChunkBytes) */
+	const unsigned int m_numChunks;
+	/** Number of chunks of each buffer that are still in flight */
+	std::vector<unsigned int> m_pendingChunks;
+	/** Number of snapshots written so far */
+	uint64_t m_numSnapshots;
+
+	/** io_uring, m_ringFd < 0 if not used */
+	int m_ringFd;
+	void *m_sqRing;
+	size_t m_sqRingBytes;
+	void *m_cqRing;
+	size_t m_cqRingBytes;
+#ifdef __linux__
+	struct io_uring_sqe *m_sqes;
+	size_t m_sqesBytes;
+	unsigned int *m_sqTail;
+	unsigned int m_sqMask;
+	unsigned int *m_sqArray;
+	unsigned int *m_cqHead;
+	unsigned int *m_cqTail;
+	unsigned int m_cqMask;
+	struct io_uring_cqe *m_cqes;
+#endif
+
+public:
+	/**
+	 * @param filename output file (truncated)
+	 * @param size number of cells
+	 * @param numBuffers number of snapshot buffers, at most numBuffers - 1
+	 *  writes are in flight while the next buffer is filled
+	 * @param useUring try io_uring first, use pwrite() otherwise
+	 * @param pyramidFactor cells per pyramid cell, 0 for no pyramid. The
+	 *  pyramid adds about 3 / (pyramidFactor - 1) of the snapshot size.
+	 */
+	DirectWriter(const char* filename, unsigned int size, unsigned int numBuffers = 4, bool useUring = true,
+			unsigned int pyramidFactor = 0)
+		: m_fd(-1), m_direct(true), m_size(size),
+		  m_pyramidFactor(pyramidFactor > 1 ? pyramidFactor : 0),
+		  m_pyramidLevels(numPyramidLevels(size, m_pyramidFactor)),
+		  m_recordBytes(recordBytes(size, m_pyramidFactor)),
+		  m_numChunks((m_recordBytes + maxChunkBytes - 1) / maxChunkBytes),
+		  m_numSnapshots(0), m_ringFd(-1), m_sqRing(MAP_FAILED), m_sqRingBytes(0),
+		  m_cqRing(MAP_FAILED), m_cqRingBytes(0)
+	{
+#ifdef O_DIRECT
+		m_fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+#else
+		errno = EINVAL;
+#endif
+		if (m_fd < 0 && errno == EINVAL) {
+			m_direct = false;
+			m_fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		}
+		if (m_fd < 0)
+			throw std::runtime_error(std::string("Could not open ") + filename + ": " + strerror(errno));
+
+		numBuffers = std::max(numBuffers, 1u);
+		for (unsigned int i = 0; i < numBuffers; i++) {
+			void *buffer;
+			if (posix_memalign(&buffer, alignment, m_recordBytes) != 0) {
+				release();
+				throw std::runtime_error("Could not allocate the snapshot buffers");
+			}
+			// The padding is written as well
+			std::memset(buffer, 0, m_recordBytes);
+			m_buffers.push_back(static_cast<char*>(buffer));
+			m_free.push_back(numBuffers - 1 - i);
+		}
+		m_pendingChunks.resize(numBuffers);
+
+		if (useUring)
+			setupRing(numBuffers * m_numChunks);
+	}
+
+	/**
+	 * Waits for all writes. Errors are ignored, call finish() to see them.
+	 */
+	~DirectWriter()
+	{
+		try {
+			finish();
+		} catch (const std::exception&) {
+		}
+		release();
+	}
+
+	/**
+	 * Queues a snapshot. Blocks only if all buffers are in flight.
+	 *
+	 * @param h water heights, size + 2 (incl. ghost cells)
+	 * @param hu momentums, size + 2
+	 * @param b bathymetry, size + 2
+	 * @param size number of cells, must match the constructor
+	 */
+	void write(T time, const T *h, const T *hu, const T *b, unsigned int size)
+	{
+		if (size != m_size)
+			throw std::invalid_argument("Direct writer: the number of cells does not match the file");
+
+		{
+			TRACE_SCOPE("writer_buffer_wait");
+			while (m_free.empty())
+				complete(1);
+		}
+
+		unsigned int index = m_free.back();
+		m_free.pop_back();
+		char *buffer = m_buffers[index];
+
+		Header *header = reinterpret_cast<Header*>(buffer);
+		std::memcpy(header->magic, "SWE1DRCT", sizeof(header->magic));
+		header->valueSize = sizeof(T);
+		header->size = m_size;
+		header->number = m_numSnapshots;
+		header->time = time;
+		header->pyramidFactor = m_pyramidFactor;
+		header->pyramidLevels = m_pyramidLevels;
+
+		{
+			TRACE_SCOPE("writer_snapshot");
+
+			T *values = reinterpret_cast<T*>(buffer + sizeof(Header));
+			if (m_pyramidLevels) {
+				copyWithPyramid(buffer, h+1, hu+1, b+1);
+			} else {
+				std::memcpy(values, h+1, m_size * sizeof(T));
+				std::memcpy(values + m_size, hu+1, m_size * sizeof(T));
+				std::memcpy(values + 2*m_size, b+1, m_size * sizeof(T));
+			}
+		}
+
+		off_t offset = static_cast<off_t>(m_numSnapshots) * m_recordBytes;
+		m_numSnapshots++;
+
+		TRACE_SCOPE("writer_submit");
+		if (m_ringFd >= 0) {
+			submit(index, offset);
+		} else {
+			writeAll(buffer, m_recordBytes, offset);
+			m_free.push_back(index);
+		}
+	}
+
+	/**
+	 * Waits until all snapshots are on the device (but does not fsync)
+	 */
+	void finish()
+	{
+		TRACE_SCOPE("writer_flush");
+		while (m_free.size() < m_buffers.size())
+			complete(1);
+	}
+
+	/**
+	 * @return True if the writes are submitted with io_uring
+	 */
+	bool usesUring() const
+	{
+		return m_ringFd >= 0;
+	}
+
+	/**
+	 * @return True if the file was opened with O_DIRECT
+	 */
+	bool usesDirectIO() const
+	{
+		return m_direct;
+	}
+
+	/**
+	 * @return Bytes of one snapshot record in the file
+	 */
+	static size_t recordBytes(unsigned int size, unsigned int pyramidFactor = 0)
+	{
+		return pyramidOffset(size, pyramidFactor, numPyramidLevels(size, pyramidFactor) + 1);
+	}
+
+	/**
+	 * @return Number of pyramid levels (0 without pyramid)
+	 */
+	static unsigned int numPyramidLevels(unsigned int size, unsigned int pyramidFactor)
+	{
+		unsigned int levels = 0;
+		if (pyramidFactor > 1) {
+			for (; size > 1; levels++)
+				size = (size + pyramidFactor - 1) / pyramidFactor;
+		}
+		return levels;
+	}
+
+	/**
+	 * @return Number of cells of a pyramid level (level 0 are the cells)
+	 */
+	static unsigned int pyramidLevelSize(unsigned int size, unsigned int pyramidFactor, unsigned int level)
+	{
+		for (unsigned int l = 0; l < level; l++)
+			size = (size + pyramidFactor - 1) / pyramidFactor;
+		return size;
+	}
+
+	/**
+	 * @return Offset of a pyramid level (starting at 1) in the record
+	 */
+	static size_t pyramidOffset(unsigned int size, unsigned int pyramidFactor, unsigned int level)
+	{
+		size_t offset = align(sizeof(Header) + 3 * static_cast<size_t>(size) * sizeof(T));
+		for (unsigned int l = 1; l < level; l++)
+			offset += align(pyramidLevelSize(size, pyramidFactor, l) * sizeof(PyramidCell));
+		return offset;
+	}
+
+	/**
+	 * Reads the cells [begin, end) of a pyramid level with one read
+	 *
+	 * @param filename file written by a DirectWriter
+	 * @param size number of cells of the snapshots
+	 * @param snapshot number of the snapshot
+	 * @param level pyramid level, at least 1
+	 * @param cells output, end - begin cells
+	 */
+	static void readPyramid(const char* filename, unsigned int size, unsigned int pyramidFactor,
+			uint64_t snapshot, unsigned int level, unsigned int begin, unsigned int end,
+			PyramidCell *cells)
+	{
+		if (pyramidFactor < 2 || level < 1 || level > numPyramidLevels(size, pyramidFactor)
+				|| begin > end || end > pyramidLevelSize(size, pyramidFactor, level))
+			throw std::invalid_argument("Pyramid window out of range");
+
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0)
+			throw std::runtime_error(std::string("Could not open ") + filename + ": " + strerror(errno));
+
+		char *buffer = reinterpret_cast<char*>(cells);
+		size_t bytes = (end - begin) * sizeof(PyramidCell);
+		off_t offset = static_cast<off_t>(snapshot) * recordBytes(size, pyramidFactor)
+			+ pyramidOffset(size, pyramidFactor, level) + begin * sizeof(PyramidCell);
+		while (bytes > 0) {
+			ssize_t read = pread(fd, buffer, bytes, offset);
+			if (read < 0 && errno == EINTR)
+				continue;
+			if (read <= 0) {
+				close(fd);
+				throw std::runtime_error(std::string("Could not read ") + filename);
+			}
+			buffer += read;
+			bytes -= read;
+			offset += read;
+		}
+		close(fd);
+	}
+
+private:
+	static size_t align(size_t bytes)
+	{
+		return (bytes + alignment - 1) / alignment * alignment;
+	}
+
+	/**
+	 * Copies the cells into the record and builds the pyramid. Level 1 is
+	 * computed while the cells are in the cache, the higher levels only
+	 * read the level below.
+	 *
+	 * @param buffer the record
+	 * @param h water heights (without ghost cells)
+	 * @param hu momentums (without ghost cells)
+	 * @param b bathymetry (without ghost cells)
+	 */
+	void copyWithPyramid(char *buffer, const T *h, const T *hu, const T *b)
+	{
+		T *hOut = reinterpret_cast<T*>(buffer + sizeof(Header));
+		T *huOut = hOut + m_size;
+		T *bOut = huOut + m_size;
+		PyramidCell *level1 = reinterpret_cast<PyramidCell*>(buffer + pyramidOffset(m_size, m_pyramidFactor, 1));
+		const unsigned int numCells = pyramidLevelSize(m_size, m_pyramidFactor, 1);
+
+#ifdef _OPENMP
+		#pragma omp parallel
+#endif
+		{
+			{
+				TRACE_SCOPE("pyramid_chunk");
+
+#ifdef _OPENMP
+				#pragma omp for schedule(static) nowait
+#endif
+				for (unsigned int c = 0; c < numCells; c++) {
+					unsigned int begin = c * m_pyramidFactor;
+					unsigned int end = std::min(begin + m_pyramidFactor, m_size);
+
+					PyramidCell cell;
+					start(cell.h, h[begin]);
+					start(cell.hu, hu[begin]);
+					start(cell.eta, h[begin] + b[begin]);
+					for (unsigned int i = begin; i < end; i++) {
+						hOut[i] = h[i];
+						huOut[i] = hu[i];
+						bOut[i] = b[i];
+
+						add(cell.h, h[i]);
+						add(cell.hu, hu[i]);
+						add(cell.eta, h[i] + b[i]);
+					}
+
+					T scale = (T)1 / (end - begin);
+					cell.h.mean *= scale;
+					cell.hu.mean *= scale;
+					cell.eta.mean *= scale;
+					level1[c] = cell;
+				}
+			}
+
+			TRACE_BARRIER();
+		}
+
+		// Cells of the original grid per cell of the level below
+		unsigned long long width = m_pyramidFactor;
+		for (unsigned int level = 2; level <= m_pyramidLevels; level++) {
+			const PyramidCell *below = reinterpret_cast<const PyramidCell*>(
+				buffer + pyramidOffset(m_size, m_pyramidFactor, level-1));
+			PyramidCell *cells = reinterpret_cast<PyramidCell*>(
+				buffer + pyramidOffset(m_size, m_pyramidFactor, level));
+			const unsigned int numBelow = pyramidLevelSize(m_size, m_pyramidFactor, level-1);
+			const unsigned int levelSize = pyramidLevelSize(m_size, m_pyramidFactor, level);
+
+			for (unsigned int c = 0; c < levelSize; c++) {
+				unsigned int begin = c * m_pyramidFactor;
+				unsigned int end = std::min(begin + m_pyramidFactor, numBelow);
+
+				PyramidCell cell = below[begin];
+				T weightSum = 0;
+				cell.h.mean = cell.hu.mean = cell.eta.mean = 0;
+				for (unsigned int i = begin; i < end; i++) {
+					// Only the last cell of a level can be smaller
+					T weight = std::min<unsigned long long>(width, m_size - i * width);
+					merge(cell.h, below[i].h, weight);
+					merge(cell.hu, below[i].hu, weight);
+					merge(cell.eta, below[i].eta, weight);
+					weightSum += weight;
+				}
+
+				cell.h.mean /= weightSum;
+				cell.hu.mean /= weightSum;
+				cell.eta.mean /= weightSum;
+				cells[c] = cell;
+			}
+
+			width *= m_pyramidFactor;
+		}
+	}
+
+	static void start(Summary &summary, T value)
+	{
+		summary.min = summary.max = value;
+		summary.mean = 0;
+	}
+
+	/**
+	 * Adds a value, mean is the sum until the end
+	 */
+	static void add(Summary &summary, T value)
+	{
+		summary.min = std::min(summary.min, value);
+		summary.max = std::max(summary.max, value);
+		summary.mean += value;
+	}
+
+	/**
+	 * Adds a summary, mean is the weighted sum until the end
+	 */
+	static void merge(Summary &summary, const Summary &other, T weight)
+	{
+		summary.min = std::min(summary.min, other.min);
+		summary.max = std::max(summary.max, other.max);
+		summary.mean += other.mean * weight;
+	}
+
+	/**
+	 * Maps the submission and completion queues. Leaves m_ringFd < 0 if
+	 * io_uring is not available.
+	 */
+	void setupRing(unsigned int entries)
+	{
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+		struct io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+		int ringFd = syscall(__NR_io_uring_setup, entries, &params);
+		if (ringFd < 0)
+			return;
+
+		m_sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+		m_cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+			m_sqRingBytes = m_cqRingBytes = std::max(m_sqRingBytes, m_cqRingBytes);
+		m_sqesBytes = params.sq_entries * sizeof(struct io_uring_sqe);
+
+		m_sqRing = mmap(0L, m_sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ringFd, IORING_OFF_SQ_RING);
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+			m_cqRing = m_sqRing;
+		else
+			m_cqRing = mmap(0L, m_cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				ringFd, IORING_OFF_CQ_RING);
+		void *sqes = mmap(0L, m_sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ringFd, IORING_OFF_SQES);
+
+		if (m_sqRing == MAP_FAILED || m_cqRing == MAP_FAILED || sqes == MAP_FAILED) {
+			if (sqes != MAP_FAILED)
+				munmap(sqes, m_sqesBytes);
+			unmapRing();
+			close(ringFd);
+			return;
+		}
+
+		char *sq = static_cast<char*>(m_sqRing);
+		char *cq = static_cast<char*>(m_cqRing);
+		m_sqes = static_cast<struct io_uring_sqe*>(sqes);
+		m_sqTail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+		m_sqMask = *reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+		m_sqArray = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+		m_cqHead = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+		m_cqTail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+		m_cqMask = *reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+		m_cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+		m_ringFd = ringFd;
+#endif
+	}
+
+	/**
+	 * Submits the writes of buffer index (io_uring only). The queues have
+	 * room for the chunks of all buffers.
+	 */
+	void submit(unsigned int index, off_t offset)
+	{
+#ifdef __linux__
+		// The only producer, the kernel only reads the tail
+		unsigned int tail = *m_sqTail;
+
+		for (unsigned int chunk = 0; chunk < m_numChunks; chunk++) {
+			size_t begin = chunk * maxChunkBytes;
+			unsigned int slot = (tail + chunk) & m_sqMask;
+
+			struct io_uring_sqe *sqe = &m_sqes[slot];
+			std::memset(sqe, 0, sizeof(*sqe));
+			sqe->opcode = IORING_OP_WRITE;
+			sqe->fd = m_fd;
+			sqe->addr = reinterpret_cast<uint64_t>(m_buffers[index] + begin);
+			sqe->len = std::min(maxChunkBytes, m_recordBytes - begin);
+			sqe->off = offset + begin;
+			sqe->user_data = static_cast<uint64_t>(index) << 32 | chunk;
+
+			m_sqArray[slot] = slot;
+		}
+
+		m_pendingChunks[index] = m_numChunks;
+		__atomic_store_n(m_sqTail, tail + m_numChunks, __ATOMIC_RELEASE);
+
+		if (syscall(__NR_io_uring_enter, m_ringFd, m_numChunks, 0, 0, 0L, 0) < 0)
+			throw std::runtime_error(std::string("Could not submit the snapshot: ") + strerror(errno));
+#endif
+	}
+
+	/**
+	 * Waits for at least minComplete writes and returns their buffers to
+	 * the free list
+	 */
+	void complete(unsigned int minComplete)
+	{
+#ifdef __linux__
+		if (m_ringFd < 0)
+			return;
+
+		unsigned int head = *m_cqHead;
+		if (head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+			TRACE_SCOPE("writer_completion_wait");
+			int ret = syscall(__NR_io_uring_enter, m_ringFd, 0, minComplete, IORING_ENTER_GETEVENTS, 0L, 0);
+			if (ret < 0 && errno != EINTR)
+				throw std::runtime_error(std::string("Could not wait for the snapshots: ") + strerror(errno));
+		}
+
+		unsigned int tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+		for (; head != tail; head++) {
+			const struct io_uring_cqe &cqe = m_cqes[head & m_cqMask];
+			unsigned int index = cqe.user_data >> 32;
+			size_t begin = (cqe.user_data & 0xffffffff) * maxChunkBytes;
+			size_t bytes = std::min(maxChunkBytes, m_recordBytes - begin);
+			int written = cqe.res;
+
+			// Release the entry before an exception leaves it in the queue
+			__atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+
+			// The buffer is not refilled before the rest is written below
+			if (--m_pendingChunks[index] == 0)
+				m_free.push_back(index);
+
+			// Retry failed writes synchronously (e.g. IORING_OP_WRITE needs
+			// Linux 5.6), pwrite() reports persistent errors
+			if (written < 0)
+				written = 0;
+			if (static_cast<size_t>(written) < bytes) {
+				// Short write (rare), write the rest synchronously
+				const Header *header = reinterpret_cast<const Header*>(m_buffers[index]);
+				writeAll(m_buffers[index] + begin + written, bytes - written,
+					static_cast<off_t>(header->number) * m_recordBytes + begin + written);
+			}
+		}
+#endif
+	}
+
+	void writeAll(const char *buffer, size_t bytes, off_t offset)
+	{
+		while (bytes > 0) {
+			ssize_t written = pwrite(m_fd, buffer, bytes, offset);
+			if (written < 0) {
+				if (errno == EINTR)
+					continue;
+				throw std::runtime_error(std::string("Could not write the snapshot: ") + strerror(errno));
+			}
+			buffer += written;
+			bytes -= written;
+			offset += written;
+		}
+	}
+
+	void unmapRing()
+	{
+		if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing)
+			munmap(m_cqRing, m_cqRingBytes);
+		if (m_sqRing != MAP_FAILED)
+			munmap(m_sqRing, m_sqRingBytes);
+		m_sqRing = m_cqRing = MAP_FAILED;
+	}
+
+	void release()
+	{
+		if (m_ringFd >= 0) {
+#ifdef __linux__
+			munmap(m_sqes, m_sqesBytes);
+#endif
+			unmapRing();
+			close(m_ringFd);
+			m_ringFd = -1;
+		}
+
+		for (unsigned int i = 0; i < m_buffers.size(); i++)
+			free(m_buffers[i]);
+		m_buffers.clear();
+
+		if (m_fd >= 0)
+			close(m_fd);
+		m_fd = -1;
+	}
+
+	// Not copyable
+	DirectWriter(const DirectWriter&);
+	DirectWriter& operator=(const DirectWriter&);
+};
+
+}
+
+#endif /* TOOLS_DIRECTWRITER_H_ */
@@ -0,0 +1,481 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  In-situ rendering of the water surface and the bathymetry into video
+ *  frames.
+ *
+ *  FrameRenderer is a writer for Simulator. write() only copies the
+ *  surface elevation and the bathymetry into a free snapshot buffer and
+ *  queues it. Worker threads rasterize the snapshots into RGB images and
+ *  write them in order as
+ *  - PPM files (output contains a printf pattern, e.g. "frame_%05d.ppm"),
+ *  - a PPM stream (e.g. for <code>ffmpeg -f image2pipe -c:v ppm -i -</code>) or
+ *  - a YUV4MPEG2 stream (e.g. for <code>ffmpeg -i -</code> or x264).
+ *  Streams can be written to a file or, if the output starts with '|',
+ *  to the standard input of a command. If the command exits early, the
+ *  remaining frames are dropped and finish() reports the error.
+ */
+
+#ifndef TOOLS_FRAMERENDERER_H_
+#define TOOLS_FRAMERENDERER_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+
+#include "types.h"
+#include "Tracer.h"
+
+namespace tools
+{
+
+class FrameRenderer
+{
+public:
+	enum Format {
+		/** Binary PPM (P6) */
+		FormatPPM,
+		/** YUV4MPEG2 with 4:2:0 chroma subsampling */
+		FormatY4M
+	};
+
+private:
+	/** Copy of the fields of one frame */
+	struct Snapshot
+	{
+		/** Frame number */
+		unsigned int number;
+		std::vector<T> surface;
+		std::vector<T> bathymetry;
+	};
+
+	const Format m_format;
+	/** Output file or pattern */
+	std::string m_output;
+	/** Stream output (NULL for one file per frame) */
+	FILE *m_stream;
+	bool m_pipe;
+
+	/** Image size (even) */
+	const unsigned int m_width;
+	const unsigned int m_height;
+
+	/** Simulated time between two frames */
+	const T m_frameInterval;
+	T m_nextFrameTime;
+
+	/** Vertical range of the image, set from the first frame if not given */
+	bool m_haveRange;
+	T m_minValue;
+	T m_maxValue;
+
+	std::vector<Snapshot> m_snapshots;
+	/** Snapshots that can be filled */
+	std::deque<Snapshot*> m_free;
+	/** Snapshots that wait for a worker */
+	std::deque<Snapshot*> m_queue;
+	std::mutex m_mutex;
+	std::condition_variable m_freeCondition;
+	std::condition_variable m_queueCondition;
+	/** Signals the next frame to be written */
+	std::condition_variable m_outputCondition;
+
+	/** Number of the next frame that is queued */
+	unsigned int m_numFrames;
+	/** Number of the next frame that is written to the output */
+	unsigned int m_nextOutput;
+	bool m_finished;
+	/** First output error, frames are dropped after an error */
+	std::string m_error;
+
+	std::vector<std::thread> m_workers;
+
+public:
+	/**
+	 * @param output file name, printf pattern (FormatPPM only) or "|command"
+	 * @param format image format
+	 * @param width image width in pixels
+	 * @param height image height in pixels
+	 * @param frameInterval simulated time between two frames (0: every write)
+	 * @param numThreads number of worker threads
+	 */
+	FrameRenderer(const char* output, Format format = FormatY4M,
+			unsigned int width = 1280, unsigned int height = 720,
+			T frameInterval = 0, unsigned int numThreads = 2)
+		: m_format(format), m_output(output), m_stream(0L), m_pipe(false),
+		  m_width((width + 1) / 2 * 2), m_height((height + 1) / 2 * 2),
+		  m_frameInterval(frameInterval), m_nextFrameTime(0),
+		  m_haveRange(false), m_minValue(0), m_maxValue(0),
+		  m_numFrames(0), m_nextOutput(0), m_finished(false)
+	{
+		m_pipe = (output[0] == '|');
+		bool filePerFrame = (format == FormatPPM && !m_pipe && m_output.find('%') != std::string::npos);
+		if (!filePerFrame) {
+			m_stream = (m_pipe ? popen(output + 1, "w") : fopen(output, "wb"));
+			if (!m_stream)
+				throw std::runtime_error(std::string("Could not open ") + output);
+			// Nothing is left in the buffer for fclose()/pclose() to write
+			setvbuf(m_stream, 0L, _IONBF, 0);
+		}
+
+		numThreads = std::max(numThreads, 1u);
+
+		// Two more buffers than workers, so the simulation can continue
+		// while all workers are busy
+		m_snapshots.resize(numThreads + 2);
+		for (unsigned int i = 0; i < m_snapshots.size(); i++)
+			m_free.push_back(&m_snapshots[i]);
+
+		for (unsigned int i = 0; i < numThreads; i++)
+			m_workers.push_back(std::thread(&FrameRenderer::work, this));
+	}
+
+	/**
+	 * Renders the remaining frames and closes the output. Errors are
+	 * ignored, call finish() to see them.
+	 */
+	~FrameRenderer()
+	{
+		try {
+			finish();
+		} catch (const std::exception&) {
+		}
+	}
+
+	/**
+	 * Fix the vertical range of the images (default: bathymetry minimum
+	 * to surface maximum of the first frame, plus a margin)
+	 */
+	void setRange(T minValue, T maxValue)
+	{
+		m_haveRange = true;
+		m_minValue = minValue;
+		m_maxValue = maxValue;
+	}
+
+	/**
+	 * Queues a frame. Waits only if all snapshot buffers are in use.
+	 * Does nothing after an output error.
+	 *
+	 * @param h water heights, size + 2 (incl. ghost cells)
+	 * @param b bathymetry, size + 2
+	 */
+	void write(T time, const T *h, const T*, const T *b, unsigned int size)
+	{
+		if (time < m_nextFrameTime)
+			return;
+		m_nextFrameTime = time + m_frameInterval;
+
+		if (!m_haveRange)
+			initRange(h, b, size);
+
+		Snapshot *snapshot;
+		{
+			TRACE_SCOPE("frame_buffer_wait");
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (!m_error.empty())
+				return;
+			while (m_free.empty())
+				m_freeCondition.wait(lock);
+			snapshot = m_free.front();
+			m_free.pop_front();
+		}
+
+		{
+			TRACE_SCOPE("frame_snapshot");
+
+			snapshot->number = m_numFrames++;
+			snapshot->surface.resize(size);
+			snapshot->bathymetry.assign(b+1, b+size+1);
+			for (unsigned int i = 0; i < size; i++)
+				snapshot->surface[i] = h[i+1] + b[i+1];
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_queue.push_back(snapshot);
+			}
+			m_queueCondition.notify_one();
+		}
+	}
+
+	/**
+	 * Waits for all frames and closes the output
+	 *
+	 * @throws std::runtime_error if a frame could not be written or the
+	 *  command failed
+	 */
+	void finish()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_finished)
+				return;
+			m_finished = true;
+		}
+
+		TRACE_SCOPE("renderer_flush");
+		m_queueCondition.notify_all();
+
+		for (unsigned int i = 0; i < m_workers.size(); i++)
+			m_workers[i].join();
+		m_workers.clear();
+
+		if (m_stream) {
+			if (m_pipe) {
+				int status = pclose(m_stream);
+				if (status != 0 && m_error.empty())
+					m_error = "Command " + m_output.substr(1) + " failed";
+			} else if (fclose(m_stream) != 0 && m_error.empty()) {
+				m_error = "Could not close " + m_output + ": " + strerror(errno);
+			}
+			m_stream = 0L;
+		}
+
+		if (!m_error.empty())
+			throw std::runtime_error(m_error);
+	}
+
+	/**
+	 * @return Number of frames queued so far
+	 */
+	unsigned int numFrames() const
+	{
+		return m_numFrames;
+	}
+
+private:
+	void initRange(const T *h, const T *b, unsigned int size)
+	{
+		m_minValue = b[1];
+		m_maxValue = h[1] + b[1];
+		for (unsigned int i = 1; i < size+1; i++) {
+			m_minValue = std::min(m_minValue, b[i]);
+			m_maxValue = std::max(m_maxValue, h[i] + b[i]);
+		}
+
+		T margin = (m_maxValue - m_minValue) * (T)0.1;
+		if (margin <= 0)
+			margin = 1;
+		m_minValue -= margin;
+		m_maxValue += margin;
+		m_haveRange = true;
+	}
+
+	/**
+	 * Worker thread: renders queued snapshots and writes them in order
+	 */
+	void work()
+	{
+		// A closed pipe fails the writes with EPIPE instead of killing
+		// the process (SIGPIPE is sent to the writing thread)
+		sigset_t pipeSignal;
+		sigemptyset(&pipeSignal);
+		sigaddset(&pipeSignal, SIGPIPE);
+		pthread_sigmask(SIG_BLOCK, &pipeSignal, 0L);
+
+		std::vector<unsigned char> rgb(m_width * m_height * 3);
+		std::vector<unsigned char> yuv;
+
+		while (true) {
+			Snapshot *snapshot;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				while (m_queue.empty() && !m_finished)
+					m_queueCondition.wait(lock);
+				if (m_queue.empty())
+					return;
+				snapshot = m_queue.front();
+				m_queue.pop_front();
+			}
+
+			{
+				TRACE_SCOPE("frame_render");
+
+				render(*snapshot, &rgb[0]);
+				if (m_format == FormatY4M)
+					toYUV420(&rgb[0], yuv);
+			}
+
+			unsigned int number = snapshot->number;
+			bool failed;
+			{
+				TRACE_SCOPE("frame_order_wait");
+
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_free.push_back(snapshot);
+				m_freeCondition.notify_one();
+
+				while (m_nextOutput != number)
+					m_outputCondition.wait(lock);
+				failed = !m_error.empty();
+			}
+
+			std::string error;
+			if (!failed) {
+				TRACE_SCOPE("frame_output");
+
+				// Only the thread with the next frame writes
+				if (m_format == FormatY4M)
+					error = writeY4M(number, yuv);
+				else
+					error = writePPM(number, &rgb[0]);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_error.empty())
+					m_error = error;
+				m_nextOutput++;
+			}
+			m_outputCondition.notify_all();
+		}
+	}
+
+	/**
+	 * Rasterizes one snapshot: ground below the bathymetry, water up to
+	 * the surface, sky above.
+	 */
+	void render(const Snapshot &snapshot, unsigned char *rgb) const
+	{
+		static const unsigned char sky[] = { 235, 242, 250 };
+		static const unsigned char water[] = { 30, 100, 200 };
+		static const unsigned char ground[] = { 120, 90, 60 };
+
+		const unsigned int size = snapshot.surface.size();
+		const T scale = (m_maxValue - m_minValue) / m_height;
+
+		for (unsigned int x = 0; x < m_width; x++) {
+			// Mean of the cells covered by this pixel column
+			unsigned int begin = static_cast<uint64_t>(x) * size / m_width;
+			unsigned int end = std::max(static_cast<unsigned int>(static_cast<uint64_t>(x+1) * size / m_width),
+				begin + 1);
+			end = std::min(end, size);
+
+			T surface = 0, bathymetry = 0;
+			for (unsigned int i = begin; i < end; i++) {
+				surface += snapshot.surface[i];
+				bathymetry += snapshot.bathymetry[i];
+			}
+			surface /= (end - begin);
+			bathymetry /= (end - begin);
+
+			for (unsigned int y = 0; y < m_height; y++) {
+				T value = m_maxValue - (y + (T)0.5) * scale;
+				const unsigned char *color = (value < bathymetry ? ground
+					: (value < surface ? water : sky));
+
+				unsigned char *pixel = rgb + (y * m_width + x) * 3;
+				pixel[0] = color[0];
+				pixel[1] = color[1];
+				pixel[2] = color[2];
+			}
+		}
+	}
+
+	/**
+	 * Converts to planar YUV 4:2:0 (BT.601, full range)
+	 */
+	void toYUV420(const unsigned char *rgb, std::vector<unsigned char> &yuv) const
+	{
+		const unsigned int w = m_width, h = m_height;
+		yuv.resize(w * h * 3 / 2);
+		unsigned char *yPlane = &yuv[0];
+		unsigned char *uPlane = yPlane + w * h;
+		unsigned char *vPlane = uPlane + w * h / 4;
+
+		for (unsigned int i = 0; i < w * h; i++) {
+			const unsigned char *p = rgb + i * 3;
+			yPlane[i] = static_cast<unsigned char>(0.299f * p[0] + 0.587f * p[1] + 0.114f * p[2] + 0.5f);
+		}
+
+		for (unsigned int y = 0; y < h; y += 2) {
+			for (unsigned int x = 0; x < w; x += 2) {
+				float r = 0, g = 0, b = 0;
+				for (unsigned int dy = 0; dy < 2; dy++) {
+					for (unsigned int dx = 0; dx < 2; dx++) {
+						const unsigned char *p = rgb + ((y+dy) * w + x+dx) * 3;
+						r += p[0]; g += p[1]; b += p[2];
+					}
+				}
+				r *= 0.25f; g *= 0.25f; b *= 0.25f;
+
+				unsigned int i = (y/2) * (w/2) + x/2;
+				uPlane[i] = static_cast<unsigned char>(std::min(std::max(
+					-0.168736f * r - 0.331264f * g + 0.5f * b + 128.5f, 0.f), 255.f));
+				vPlane[i] = static_cast<unsigned char>(std::min(std::max(
+					0.5f * r - 0.418688f * g - 0.081312f * b + 128.5f, 0.f), 255.f));
+			}
+		}
+	}
+
+	/**
+	 * @return An error message, empty on success
+	 */
+	std::string writePPM(unsigned int number, const unsigned char *rgb)
+	{
+		FILE *out = m_stream;
+		std::string name = m_output;
+		if (!out) {
+			std::vector<char> buffer(m_output.size() + 32);
+			snprintf(&buffer[0], buffer.size(), m_output.c_str(), number);
+			name = &buffer[0];
+			out = fopen(name.c_str(), "wb");
+			if (!out)
+				return "Could not open " + name + ": " + strerror(errno);
+		}
+
+		const size_t bytes = m_width * m_height * 3;
+		bool ok = fprintf(out, "P6\n%u %u\n255\n", m_width, m_height) > 0
+			&& fwrite(rgb, 1, bytes, out) == bytes;
+		int error = errno;
+
+		if (out != m_stream && fclose(out) != 0 && ok) {
+			ok = false;
+			error = errno;
+		}
+
+		if (!ok)
+			return "Could not write frame to " + name + ": " + strerror(error);
+		return std::string();
+	}
+
+	/**
+	 * @return An error message, empty on success
+	 */
+	std::string writeY4M(unsigned int number, const std::vector<unsigned char> &yuv)
+	{
+		bool ok = true;
+		if (number == 0)
+			// 25 frames per second, progressive, square pixels
+			ok = fprintf(m_stream, "YUV4MPEG2 W%u H%u F25:1 Ip A1:1 C420jpeg\n", m_width, m_height) > 0;
+
+		ok = ok && fputs("FRAME\n", m_stream) >= 0
+			&& fwrite(&yuv[0], 1, yuv.size(), m_stream) == yuv.size();
+
+		if (!ok)
+			return "Could not write frame to " + m_output + ": " + strerror(errno);
+		return std::string();
+	}
+
+	// Not copyable
+	FrameRenderer(const FrameRenderer&);
+	FrameRenderer& operator=(const FrameRenderer&);
+};
+
+}
+
+#endif /* TOOLS_FRAMERENDERER_H_ */
@@ -0,0 +1,219 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Validation of the unknowns, run every few time steps instead of
+ *  asserts in the edge solver.
+ *
+ *  The cells are scanned in blocks. The loop over a block has no
+ *  branches (all conditions are combined into one flag), so it is
+ *  vectorized by the compiler. Only the first block with a problem is
+ *  scanned again to find the cell and the kind of the problem.
+ */
+
+#ifndef TOOLS_HEALTHCHECK_H_
+#define TOOLS_HEALTHCHECK_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+
+#include "types.h"
+#include "solvers/FWave.hpp"
+
+namespace tools
+{
+
+class HealthCheck
+{
+public:
+	enum Problem {
+		Healthy,
+		/** NaN or infinite height or momentum */
+		NotFinite,
+		/** Negative height */
+		NegativeDepth,
+		/** Absolute momentum above the limit */
+		ExplodingMomentum,
+		/** Local Courant number above the limit */
+		CflViolation
+	};
+
+	struct Report
+	{
+		Problem problem;
+		/** First cell with a problem (incl. ghost cells, the first cell is 1) */
+		unsigned int cell;
+		/** Time step of the check */
+		unsigned long step;
+		/** The offending value (height, momentum or Courant number) */
+		T value;
+
+		Report()
+			: problem(Healthy), cell(0), step(0), value(0)
+		{
+		}
+	};
+
+private:
+	const T m_cellSize;
+	/** Largest allowed absolute momentum */
+	const T m_maxMomentum;
+	/** Largest allowed local Courant number (|u| + sqrt(g*h)) * dt / dx */
+	const T m_maxCflNumber;
+
+	/** Cells per block */
+	static const unsigned int blockSize = 1024;
+
+public:
+	/**
+	 * @param cellSize size of one cell
+	 * @param maxMomentum largest allowed absolute momentum
+	 * @param maxCflNumber largest allowed local Courant number (FWave is
+	 *  stable up to 1)
+	 */
+	HealthCheck(T cellSize, T maxMomentum = 1e6, T maxCflNumber = 1)
+		: m_cellSize(cellSize), m_maxMomentum(maxMomentum), m_maxCflNumber(maxCflNumber)
+	{
+	}
+
+	/**
+	 * Checks the cells 1 .. size.
+	 *
+	 * @param h water heights, size + 2 (incl. ghost cells)
+	 * @param hu momentums, size + 2
+	 * @param dt time step used with these values (for the CFL condition)
+	 * @param step number of the time step (only copied to the report)
+	 * @return The problem of the first offending cell
+	 */
+	Report check(const T *h, const T *hu, unsigned int size, T dt, unsigned long step) const
+	{
+		const unsigned int numBlocks = (size + blockSize - 1) / blockSize;
+		// Largest wave speed that satisfies the CFL condition
+		const T maxWaveSpeed = m_maxCflNumber * m_cellSize / dt;
+
+		unsigned int firstBad = numBlocks;
+
+#ifdef _OPENMP
+		#pragma omp parallel for schedule(static) reduction(min:firstBad)
+#endif
+		for (unsigned int block = 0; block < numBlocks; block++) {
+			unsigned int begin = block * blockSize + 1;
+			unsigned int end = std::min(begin + blockSize, size + 1);
+
+			if (!blockHealthy(h, hu, begin, end, maxWaveSpeed))
+				firstBad = std::min(firstBad, block);
+		}
+
+		Report report;
+		report.step = step;
+		if (firstBad == numBlocks)
+			return report;
+
+		// Continues after the block if the problem was at the limit of the
+		// CFL condition and the exact check passes
+		for (unsigned int i = firstBad * blockSize + 1; i < size + 1; i++) {
+			if (problem(h[i], hu[i], dt, report)) {
+				report.cell = i;
+				break;
+			}
+		}
+
+		return report;
+	}
+
+	/**
+	 * @return A short description of the problem
+	 */
+	static const char* name(Problem problem)
+	{
+		switch (problem) {
+		case Healthy:
+			return "healthy";
+		case NotFinite:
+			return "not finite";
+		case NegativeDepth:
+			return "negative depth";
+		case ExplodingMomentum:
+			return "exploding momentum";
+		case CflViolation:
+			return "CFL violation";
+		}
+		return "unknown";
+	}
+
+private:
+	/**
+	 * Branch free scan of the cells [begin, end)
+	 *
+	 * @return True if no cell has a problem
+	 */
+	bool blockHealthy(const T *h, const T *hu, unsigned int begin, unsigned int end, T maxWaveSpeed) const
+	{
+		const T maxValue = std::numeric_limits<T>::max();
+		const T g = solver::FWave<T>::g;
+		const T dryTol = solver::FWave<T>::dryTol;
+
+		int bad = 0;
+		for (unsigned int i = begin; i < end; i++) {
+			// Written as !(... <= ...), so NaN counts as a problem
+			T absHu = std::fabs(hu[i]);
+			bad |= !(h[i] >= 0) | !(h[i] <= maxValue) | !(absHu <= m_maxMomentum);
+
+			// |u| + sqrt(g*h) <= maxWaveSpeed without sqrt (dry cells do
+			// not move)
+			T rest = maxWaveSpeed - absHu / std::max(h[i], dryTol);
+			bad |= (h[i] >= dryTol) & (!(rest >= 0) | !(g * h[i] <= rest * rest));
+		}
+
+		return !bad;
+	}
+
+	/**
+	 * @param report output, kind and value of the problem
+	 * @return True if the cell has a problem
+	 */
+	bool problem(T h, T hu, T dt, Report &report) const
+	{
+		if (!std::isfinite(h) || !std::isfinite(hu)) {
+			report.problem = NotFinite;
+			report.value = std::isfinite(h) ? hu : h;
+		} else if (h < 0) {
+			report.problem = NegativeDepth;
+			report.value = h;
+		} else if (std::fabs(hu) > m_maxMomentum) {
+			report.problem = ExplodingMomentum;
+			report.value = hu;
+		} else if (h >= solver::FWave<T>::dryTol) {
+			T courant = (std::fabs(hu) / h + std::sqrt(solver::FWave<T>::g * h)) * dt / m_cellSize;
+			if (courant <= m_maxCflNumber)
+				return false;
+
+			report.problem = CflViolation;
+			report.value = courant;
+		} else {
+			return false;
+		}
+
+		return true;
+	}
+};
+
+/**
+ * Writes e.g. "negative depth in cell 17 at step 1200 (value -0.3)"
+ */
+inline std::ostream& operator<<(std::ostream &out, const HealthCheck::Report &report)
+{
+	out << HealthCheck::name(report.problem);
+	if (report.problem != HealthCheck::Healthy)
+		out << " in cell " << report.cell;
+	out << " at step " << report.step;
+	if (report.problem != HealthCheck::Healthy)
+		out << " (value " << report.value << ')';
+	return out;
+}
+
+}
+
+#endif /* TOOLS_HEALTHCHECK_H_ */
@@ -0,0 +1,245 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Phase timers and counters for the hot path.
+ *
+ *  Everything is compiled out unless SWE1D_INSTRUMENTATION is defined. Use
+ *  the macros at the end of this file, not the classes directly.
+ *
+ *  Each thread writes only to its own (cache line aligned) block. The
+ *  blocks are registered without locks and summed up by dump(), which
+ *  must be called after all worker threads finished.
+ */
+
+#ifndef TOOLS_INSTRUMENTATION_H_
+#define TOOLS_INSTRUMENTATION_H_
+
+#ifdef SWE1D_INSTRUMENTATION
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <ostream>
+#include <stdint.h>
+
+#include "Timer.h"
+
+namespace tools
+{
+
+class Instrumentation
+{
+public:
+	enum Phase {
+		/** Boundary conditions */
+		Boundary,
+		/** Net updates on all edges */
+		EdgeSolve,
+		/** Update of the unknowns */
+		CellUpdate,
+		/** Maximum wave speed and residual of the threads (and ranks) */
+		Reduction,
+		/** Writing checkpoints */
+		Output,
+		NumPhases
+	};
+
+	enum Counter {
+		/** Edges by solver::FWave::CellType */
+		EdgesWetWet,
+		EdgesDryDry,
+		EdgesWetDry,
+		EdgesDryWet,
+		/** Edges solved with Rusanov by solver::Hybrid */
+		EdgesSmooth,
+		/** Determinants below zeroTol in solver::FWave::inverseMatrix */
+		DegenerateDeterminants,
+		/** Blocks of 64 dry edges skipped with the wet/dry bitmap of WavePropagation */
+		DryBlocksSkipped,
+		NumCounters
+	};
+
+	/** Maximum number of threads that are recorded */
+	static const unsigned int maxThreads = 256;
+
+	struct alignas(64) ThreadData
+	{
+		uint64_t phaseNs[NumPhases];
+		uint64_t phaseCalls[NumPhases];
+		uint64_t counters[NumCounters];
+
+		/** Statistics of the time steps */
+		uint64_t timeSteps;
+		double timeStepSum;
+		double timeStepMin;
+		double timeStepMax;
+
+		ThreadData()
+			: timeSteps(0), timeStepSum(0),
+			  timeStepMin(std::numeric_limits<double>::max()), timeStepMax(0)
+		{
+			std::fill(phaseNs, phaseNs + NumPhases, 0);
+			std::fill(phaseCalls, phaseCalls + NumPhases, 0);
+			std::fill(counters, counters + NumCounters, 0);
+		}
+	};
+
+	/**
+	 * @return Data of the calling thread
+	 */
+	static ThreadData& local()
+	{
+		// Constant initialization avoids the TLS wrapper call
+		static thread_local ThreadData* data = 0L;
+		if (__builtin_expect(!data, 0))
+			data = registerThread();
+		return *data;
+	}
+
+	static void count(Counter counter)
+	{
+		local().counters[counter]++;
+	}
+
+	static void timeStep(double dt)
+	{
+		ThreadData &data = local();
+		data.timeSteps++;
+		data.timeStepSum += dt;
+		data.timeStepMin = std::min(data.timeStepMin, dt);
+		data.timeStepMax = std::max(data.timeStepMax, dt);
+	}
+
+	/**
+	 * Sums up the data of all threads and writes it as JSON object
+	 */
+	static void dump(std::ostream &out)
+	{
+		ThreadData total;
+		unsigned int numThreads = std::min(threadCount().load(), maxThreads);
+
+		for (unsigned int t = 0; t < numThreads; t++) {
+			const ThreadData &data = threads()[t];
+			for (unsigned int i = 0; i < NumPhases; i++) {
+				total.phaseNs[i] += data.phaseNs[i];
+				total.phaseCalls[i] += data.phaseCalls[i];
+			}
+			for (unsigned int i = 0; i < NumCounters; i++)
+				total.counters[i] += data.counters[i];
+			total.timeSteps += data.timeSteps;
+			total.timeStepSum += data.timeStepSum;
+			total.timeStepMin = std::min(total.timeStepMin, data.timeStepMin);
+			total.timeStepMax = std::max(total.timeStepMax, data.timeStepMax);
+		}
+
+		out << "{\"threads\": " << numThreads << ", \"phases\": {";
+		for (unsigned int i = 0; i < NumPhases; i++) {
+			out << (i ? ", \"" : "\"") << phaseName(static_cast<Phase>(i))
+				<< "\": {\"seconds\": " << total.phaseNs[i] * 1e-9
+				<< ", \"calls\": " << total.phaseCalls[i] << '}';
+		}
+		out << "}, \"counters\": {";
+		for (unsigned int i = 0; i < NumCounters; i++) {
+			out << (i ? ", \"" : "\"") << counterName(static_cast<Counter>(i))
+				<< "\": " << total.counters[i];
+		}
+		out << "}, \"time_steps\": {\"count\": " << total.timeSteps;
+		if (total.timeSteps) {
+			out << ", \"min\": " << total.timeStepMin
+				<< ", \"max\": " << total.timeStepMax
+				<< ", \"mean\": " << total.timeStepSum / total.timeSteps;
+		}
+		out << "}}" << std::endl;
+	}
+
+	static const char* phaseName(Phase phase)
+	{
+		static const char* names[NumPhases] = {
+			"boundary", "edge_solve", "cell_update", "reduction", "output"
+		};
+		return names[phase];
+	}
+
+	static const char* counterName(Counter counter)
+	{
+		static const char* names[NumCounters] = {
+			"edges_wetwet", "edges_drydry", "edges_wetdry", "edges_drywet",
+			"edges_smooth", "degenerate_determinants",
+			"dry_blocks_skipped"
+		};
+		return names[counter];
+	}
+
+private:
+	static ThreadData* threads()
+	{
+		static ThreadData data[maxThreads];
+		return data;
+	}
+
+	static std::atomic<unsigned int>& threadCount()
+	{
+		static std::atomic<unsigned int> count(0);
+		return count;
+	}
+
+	static ThreadData* registerThread()
+	{
+		unsigned int id = threadCount().fetch_add(1);
+		if (id >= maxThreads)
+			// Too many threads, share the last block (the numbers
+			// of these threads may be inaccurate)
+			id = maxThreads - 1;
+		return &threads()[id];
+	}
+};
+
+/**
+ * Measures the time until the end of the scope
+ */
+class ScopedPhase
+{
+private:
+	const Instrumentation::Phase m_phase;
+	const uint64_t m_start;
+
+public:
+	ScopedPhase(Instrumentation::Phase phase)
+		: m_phase(phase), m_start(Timer::nowNs())
+	{
+	}
+
+	~ScopedPhase()
+	{
+		Instrumentation::ThreadData &data = Instrumentation::local();
+		data.phaseNs[m_phase] += Timer::nowNs() - m_start;
+		data.phaseCalls[m_phase]++;
+	}
+};
+
+}
+
+#define SWE1D_INSTR_CONCAT_(a, b) a##b
+#define SWE1D_INSTR_CONCAT(a, b) SWE1D_INSTR_CONCAT_(a, b)
+
+/** Time the rest of the current scope as phase */
+#define INSTR_PHASE(phase) \
+	tools::ScopedPhase SWE1D_INSTR_CONCAT(instrPhase, __LINE__)(tools::Instrumentation::phase)
+/** Increment a counter */
+#define INSTR_COUNT(counter) tools::Instrumentation::count(tools::Instrumentation::counter)
+/** Record the size of a time step */
+#define INSTR_TIME_STEP(dt) tools::Instrumentation::timeStep(dt)
+/** Write all collected data to a stream */
+#define INSTR_DUMP(out) tools::Instrumentation::dump(out)
+
+#else // SWE1D_INSTRUMENTATION
+
+#define INSTR_PHASE(phase)
+#define INSTR_COUNT(counter) ((void) 0)
+#define INSTR_TIME_STEP(dt) ((void) 0)
+#define INSTR_DUMP(out) ((void) 0)
+
+#endif // SWE1D_INSTRUMENTATION
+
+#endif /* TOOLS_INSTRUMENTATION_H_ */
@@ -0,0 +1,319 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Live feed of the simulation through a POSIX shared memory ring buffer.
+ *
+ *  The simulation (LiveFeed, a writer for Simulator) copies h, hu and b
+ *  into the next of numFrames frames. Other processes (LiveFeedReader)
+ *  map the segment read-only and read the latest frames directly.
+ *
+ *  Each frame is protected by a sequence lock: the writer makes the
+ *  sequence number odd before and even after writing. A reader checks
+ *  that the number is even and unchanged after reading, otherwise the
+ *  frame was overwritten and the reader retries with a newer one. The
+ *  writer never waits for readers.
+ */
+
+#ifndef TOOLS_LIVEFEED_H_
+#define TOOLS_LIVEFEED_H_
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "types.h"
+
+namespace tools
+{
+
+/**
+ * Layout of the shared memory segment
+ */
+class LiveFeedLayout
+{
+public:
+	/** Identifies a valid segment */
+	static const uint32_t magic = 0x53574531; // "SWE1"
+
+	struct alignas(64) Header
+	{
+		uint32_t magic;
+		/** sizeof(T) */
+		uint32_t valueSize;
+		uint32_t numFrames;
+		/** Number of cells in each frame */
+		uint32_t size;
+		/** Number of frames written so far, the latest is (count - 1) % numFrames */
+		std::atomic<uint64_t> count;
+	};
+
+	struct alignas(64) FrameHeader
+	{
+		/** Odd while the frame is written */
+		std::atomic<uint64_t> seq;
+		/** Number of the frame (counting all frames written) */
+		uint64_t number;
+		/** Simulated time */
+		double time;
+	};
+
+	/**
+	 * @return Bytes of one frame (header, h, hu and b without ghost cells)
+	 */
+	static size_t frameBytes(unsigned int size)
+	{
+		return (sizeof(FrameHeader) + 3 * size * sizeof(T) + 63) / 64 * 64;
+	}
+
+	static size_t segmentBytes(unsigned int size, unsigned int numFrames)
+	{
+		return sizeof(Header) + numFrames * frameBytes(size);
+	}
+};
+
+/**
+ * Writer side, used as the writer of a Simulator
+ */
+class LiveFeed
+{
+private:
+	std::string m_name;
+	size_t m_segmentSize;
+	char *m_segment;
+	LiveFeedLayout::Header *m_header;
+	const unsigned int m_size;
+
+public:
+	/**
+	 * Creates the segment (replaces an existing one with the same name)
+	 *
+	 * @param name name of the segment, e.g. "/swe1d-live"
+	 * @param size number of cells
+	 * @param numFrames number of frames in the ring buffer, at least 1.
+	 *  Readers that need longer than numFrames - 1 writes for one frame
+	 *  have to retry.
+	 */
+	LiveFeed(const char* name, unsigned int size, unsigned int numFrames = 8)
+		: m_name(name), m_segmentSize(LiveFeedLayout::segmentBytes(size, numFrames)),
+		  m_segment(0L), m_header(0L), m_size(size)
+	{
+		if (numFrames < 1)
+			throw std::invalid_argument("Live feed needs at least one frame");
+
+		shm_unlink(name);
+		int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+		if (fd < 0 || ftruncate(fd, m_segmentSize) != 0)
+			throw std::runtime_error(std::string("Could not create ") + name + ": " + strerror(errno));
+
+		void *segment = mmap(0L, m_segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if (segment == MAP_FAILED)
+			throw std::runtime_error(std::string("Could not map ") + name + ": " + strerror(errno));
+
+		m_segment = static_cast<char*>(segment);
+		m_header = reinterpret_cast<LiveFeedLayout::Header*>(m_segment);
+		m_header->valueSize = sizeof(T);
+		m_header->numFrames = numFrames;
+		m_header->size = size;
+		m_header->count.store(0, std::memory_order_relaxed);
+		// Readers check the magic last
+		std::atomic_thread_fence(std::memory_order_release);
+		m_header->magic = LiveFeedLayout::magic;
+	}
+
+	/**
+	 * Removes the segment. Readers that are still attached keep their mapping.
+	 */
+	~LiveFeed()
+	{
+		munmap(m_segment, m_segmentSize);
+		shm_unlink(m_name.c_str());
+	}
+
+	/**
+	 * Publishes a new frame
+	 *
+	 * @param h water heights, size + 2 (incl. ghost cells)
+	 * @param hu momentums, size + 2
+	 * @param b bathymetry, size + 2
+	 * @param size number of cells, must match the constructor
+	 */
+	void write(T time, const T *h, const T *hu, const T *b, unsigned int size)
+	{
+		if (size != m_size)
+			throw std::invalid_argument("Live feed: the number of cells does not match the segment");
+
+		uint64_t number = m_header->count.load(std::memory_order_relaxed);
+		char *frame = m_segment + sizeof(LiveFeedLayout::Header)
+			+ (number % m_header->numFrames) * LiveFeedLayout::frameBytes(m_size);
+		LiveFeedLayout::FrameHeader *frameHeader = reinterpret_cast<LiveFeedLayout::FrameHeader*>(frame);
+		T *values = reinterpret_cast<T*>(frame + sizeof(LiveFeedLayout::FrameHeader));
+
+		uint64_t seq = frameHeader->seq.load(std::memory_order_relaxed);
+		frameHeader->seq.store(seq + 1, std::memory_order_relaxed);
+		// The odd sequence number has to be visible before the data changes
+		std::atomic_thread_fence(std::memory_order_release);
+
+		frameHeader->number = number;
+		frameHeader->time = time;
+		std::memcpy(values, h+1, m_size * sizeof(T));
+		std::memcpy(values + m_size, hu+1, m_size * sizeof(T));
+		std::memcpy(values + 2*m_size, b+1, m_size * sizeof(T));
+
+		frameHeader->seq.store(seq + 2, std::memory_order_release);
+		m_header->count.store(number + 1, std::memory_order_release);
+	}
+
+private:
+	// Not copyable
+	LiveFeed(const LiveFeed&);
+	LiveFeed& operator=(const LiveFeed&);
+};
+
+/**
+ * Reader side, for viewers and analysis tools
+ */
+class LiveFeedReader
+{
+private:
+	size_t m_segmentSize;
+	const char *m_segment;
+	const LiveFeedLayout::Header *m_header;
+
+public:
+	/**
+	 * Attaches to the segment of a running simulation
+	 */
+	LiveFeedReader(const char* name)
+	{
+		int fd = shm_open(name, O_RDONLY, 0);
+		struct stat st;
+		if (fd < 0 || fstat(fd, &st) != 0)
+			throw std::runtime_error(std::string("Could not open ") + name + ": " + strerror(errno));
+
+		m_segmentSize = st.st_size;
+		void *segment = mmap(0L, m_segmentSize, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (segment == MAP_FAILED)
+			throw std::runtime_error(std::string("Could not map ") + name + ": " + strerror(errno));
+
+		m_segment = static_cast<const char*>(segment);
+		m_header = reinterpret_cast<const LiveFeedLayout::Header*>(m_segment);
+
+		if (m_segmentSize < sizeof(LiveFeedLayout::Header) || m_header->magic != LiveFeedLayout::magic
+				|| m_header->valueSize != sizeof(T) || m_header->numFrames < 1
+				|| m_segmentSize < LiveFeedLayout::segmentBytes(m_header->size, m_header->numFrames)) {
+			munmap(const_cast<char*>(m_segment), m_segmentSize);
+			throw std::runtime_error(std::string("Not a (compatible) live feed: ") + name);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+	}
+
+	~LiveFeedReader()
+	{
+		munmap(const_cast<char*>(m_segment), m_segmentSize);
+	}
+
+	/**
+	 * @return Number of cells in each frame
+	 */
+	unsigned int size() const
+	{
+		return m_header->size;
+	}
+
+	/**
+	 * @return Number of frames written so far
+	 */
+	uint64_t count() const
+	{
+		return m_header->count.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Starts reading frame number (zero copy). The values may be
+	 * overwritten at any time, so they are only valid if endRead()
+	 * returns true.
+	 *
+	 * @param number frame number, count() - numFrames <= number < count()
+	 * @param seq output, pass to endRead()
+	 * @param time output, simulated time of the frame
+	 * @return h, followed by hu and b (size() values each, without ghost
+	 *  cells), NULL if the frame is not available
+	 */
+	const T* beginRead(uint64_t number, uint64_t &seq, double &time) const
+	{
+		const LiveFeedLayout::FrameHeader *frameHeader = frame(number);
+		seq = frameHeader->seq.load(std::memory_order_acquire);
+		if ((seq & 1) || frameHeader->number != number)
+			return 0L;
+
+		time = frameHeader->time;
+		return reinterpret_cast<const T*>(reinterpret_cast<const char*>(frameHeader)
+			+ sizeof(LiveFeedLayout::FrameHeader));
+	}
+
+	/**
+	 * @return True if the frame was not modified since beginRead()
+	 */
+	bool endRead(uint64_t number, uint64_t seq) const
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return frame(number)->seq.load(std::memory_order_relaxed) == seq;
+	}
+
+	/**
+	 * Copies the latest complete frame
+	 *
+	 * @param h output, size() values (without ghost cells)
+	 * @param hu output, size() values
+	 * @param b output, size() values
+	 * @return The frame number, or -1 if no frame was written yet
+	 */
+	int64_t readLatest(double &time, T *h, T *hu, T *b) const
+	{
+		const unsigned int size = m_header->size;
+
+		while (true) {
+			uint64_t n = count();
+			if (n == 0)
+				return -1;
+
+			uint64_t seq;
+			const T *values = beginRead(n-1, seq, time);
+			if (!values)
+				continue;
+
+			std::memcpy(h, values, size * sizeof(T));
+			std::memcpy(hu, values + size, size * sizeof(T));
+			std::memcpy(b, values + 2*size, size * sizeof(T));
+
+			if (endRead(n-1, seq))
+				return n-1;
+		}
+	}
+
+private:
+	const LiveFeedLayout::FrameHeader* frame(uint64_t number) const
+	{
+		return reinterpret_cast<const LiveFeedLayout::FrameHeader*>(m_segment + sizeof(LiveFeedLayout::Header)
+			+ (number % m_header->numFrames) * LiveFeedLayout::frameBytes(m_header->size));
+	}
+
+	// Not copyable
+	LiveFeedReader(const LiveFeedReader&);
+	LiveFeedReader& operator=(const LiveFeedReader&);
+};
+
+}
+
+#endif /* TOOLS_LIVEFEED_H_ */
@@ -0,0 +1,50 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Static partitioning of loops among OpenMP threads.
+ */
+
+#ifndef TOOLS_PARTITION_H_
+#define TOOLS_PARTITION_H_
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace tools
+{
+
+/**
+ * Computes the iterations [begin, end) of the calling thread. Uses the
+ * same distribution as <code>schedule(static)</code> in GCC and Clang,
+ * so data initialized in these ranges is first touched by the thread
+ * that later computes on it.
+ *
+ * @param size number of iterations
+ */
+inline void staticRange(unsigned int size, unsigned int &begin, unsigned int &end)
+{
+#ifdef _OPENMP
+	unsigned int numThreads = omp_get_num_threads();
+	unsigned int thread = omp_get_thread_num();
+#else
+	unsigned int numThreads = 1;
+	unsigned int thread = 0;
+#endif
+
+	unsigned int chunk = size / numThreads;
+	unsigned int rest = size % numThreads;
+
+	if (thread < rest) {
+		chunk++;
+		begin = thread * chunk;
+	} else {
+		begin = thread * chunk + rest;
+	}
+	end = begin + chunk;
+}
+
+}
+
+#endif /* TOOLS_PARTITION_H_ */
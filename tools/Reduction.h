@@ -0,0 +1,126 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Reductions that give bitwise identical results for any number of
+ *  threads.
+ *
+ *  Floating point additions are not associative, so the result of
+ *  <code>reduction(+:...)</code> depends on how the loop is split among
+ *  the threads. Here the loop is split into chunks of fixed size instead.
+ *  Each chunk is summed up serially (by whichever thread gets it) and the
+ *  partial sums are combined in a fixed pairwise tree.
+ *
+ *  Maximum and minimum reductions are exact and need no special care.
+ *
+ *  ThreadValues collects one value per thread of a parallel region, so
+ *  the reduction runs after the region and can be timed on its own.
+ */
+
+#ifndef TOOLS_REDUCTION_H_
+#define TOOLS_REDUCTION_H_
+
+#include <algorithm>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace tools
+{
+
+/** Iterations per chunk, independent of the number of threads */
+static const unsigned int reductionChunkSize = 4096;
+
+/**
+ * @return Number of chunks of a loop with size iterations
+ */
+inline unsigned int numReductionChunks(unsigned int size)
+{
+	return (size + reductionChunkSize - 1) / reductionChunkSize;
+}
+
+/**
+ * Computes the iterations [begin, end) of a chunk
+ */
+inline void reductionChunk(unsigned int chunk, unsigned int size, unsigned int &begin, unsigned int &end)
+{
+	begin = chunk * reductionChunkSize;
+	end = std::min(begin + reductionChunkSize, size);
+}
+
+/**
+ * Sums up the partial sums of the chunks in a fixed pairwise order
+ *
+ * @param values partial sums, overwritten
+ * @param n number of partial sums
+ */
+template<typename V>
+V treeSum(V *values, unsigned int n)
+{
+	if (n == 0)
+		return 0;
+
+	for (unsigned int stride = 1; stride < n; stride *= 2) {
+		for (unsigned int i = 0; i + stride < n; i += 2*stride)
+			values[i] += values[i+stride];
+	}
+
+	return values[0];
+}
+
+/**
+ * One value per thread of a parallel region
+ */
+template<typename V>
+class ThreadValues
+{
+private:
+	std::vector<V> m_values;
+
+public:
+	/**
+	 * Sets all values, has to be called before the parallel region
+	 */
+	void reset(V value)
+	{
+#ifdef _OPENMP
+		m_values.assign(omp_get_max_threads(), value);
+#else
+		m_values.assign(1, value);
+#endif
+	}
+
+	/**
+	 * Sets the value of the calling thread
+	 */
+	void set(V value)
+	{
+#ifdef _OPENMP
+		m_values[omp_get_thread_num()] = value;
+#else
+		m_values[0] = value;
+#endif
+	}
+
+	V max() const
+	{
+		return *std::max_element(m_values.begin(), m_values.end());
+	}
+
+	/**
+	 * @return Sum in the order of the threads
+	 */
+	V sum() const
+	{
+		V sum = 0;
+		for (unsigned int i = 0; i < m_values.size(); i++)
+			sum += m_values[i];
+		return sum;
+	}
+};
+
+}
+
+#endif /* TOOLS_REDUCTION_H_ */
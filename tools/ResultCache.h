@@ -0,0 +1,296 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  On-disk cache of simulated states, addressed by the hash of the
+ *  configuration. Parameter sweeps often submit the same configuration
+ *  again; the Simulator then replays the cached checkpoints instead of
+ *  computing them (see Simulator::enableCache()).
+ *
+ *  Each configuration has a directory with one file per cached state,
+ *  named after the simulated time ("%a", so the name is exact). A state
+ *  is everything the engine saves with getState() (e.g. the unknowns and
+ *  the tracers of WavePropagation).
+ */
+
+#ifndef TOOLS_RESULTCACHE_H_
+#define TOOLS_RESULTCACHE_H_
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "types.h"
+#include "Boundary.h"
+
+namespace tools
+{
+
+class ResultCache
+{
+public:
+	/**
+	 * 64 bit FNV-1a hash of the configuration
+	 */
+	class Key
+	{
+	private:
+		unsigned long long m_hash;
+
+	public:
+		Key()
+			: m_hash(14695981039346656037ULL)
+		{
+		}
+
+		Key& add(const void *data, size_t bytes)
+		{
+			const unsigned char *p = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < bytes; i++) {
+				m_hash ^= p[i];
+				m_hash *= 1099511628211ULL;
+			}
+			return *this;
+		}
+
+		/**
+		 * Adds the length first, so "ab" + "c" and "a" + "bc" differ
+		 */
+		Key& add(const std::string &value)
+		{
+			unsigned long long length = value.size();
+			add(&length, sizeof(length));
+			return add(value.data(), value.size());
+		}
+
+		Key& add(unsigned int value)
+		{
+			return add(&value, sizeof(value));
+		}
+
+		Key& add(T value)
+		{
+			return add(&value, sizeof(value));
+		}
+
+		/**
+		 * Adds the length first (see add(const std::string&))
+		 */
+		Key& add(const std::vector<T> &values)
+		{
+			unsigned long long length = values.size();
+			add(&length, sizeof(length));
+			return add(values.data(), values.size() * sizeof(T));
+		}
+
+		Key& add(const Boundary &boundary)
+		{
+			add(static_cast<unsigned int>(boundary.getType())).add(boundary.getDischarge());
+			return add(boundary.getTimes()).add(boundary.getDischarges());
+		}
+
+		/**
+		 * @return The hash as 16 hex digits
+		 */
+		std::string str() const
+		{
+			char buffer[17];
+			std::snprintf(buffer, sizeof(buffer), "%016llx", m_hash);
+			return buffer;
+		}
+	};
+
+private:
+	/** Header of a state file, followed by the state */
+	struct Header
+	{
+		char magic[8];
+		/** Number of values in the state */
+		unsigned int length;
+		unsigned int realSize;
+		unsigned long long steps;
+		double time;
+	};
+
+	std::string m_directory;
+
+public:
+	/**
+	 * @param directory cache directory, created if necessary
+	 */
+	ResultCache(const std::string &directory = "swe1d-cache")
+		: m_directory(directory)
+	{
+		makeDirectory(m_directory);
+	}
+
+	/**
+	 * Hashes the initial state and everything else that changes the
+	 * result. The initial state covers the scenario, its parameters and
+	 * the number of cells.
+	 *
+	 * @param h initial water heights, size + 2 (incl. ghost cells)
+	 * @param hu initial momentums, size + 2
+	 * @param b bathymetry, size + 2
+	 * @param variant everything the state does not show, e.g. the
+	 *  kernel, the CFL number and the boundary conditions (included by
+	 *  key(const Engine&, const std::string&))
+	 */
+	static Key key(const T *h, const T *hu, const T *b, unsigned int size, T cellSize,
+			const std::string &variant)
+	{
+		Key key;
+		// The ghost cells are set by the boundary conditions
+		key.add(size).add(cellSize).add(variant);
+		key.add(h+1, size * sizeof(T)).add(hu+1, size * sizeof(T)).add(b+1, size * sizeof(T));
+		return key;
+	}
+
+	/**
+	 * Hashes the initial state of an engine (incl. the tracers), its
+	 * kernel, CFL number and boundary conditions. The engine needs
+	 * getState(), getKernel(), getCflNumber(), getBoundary() and
+	 * getCellSize() (e.g. WavePropagation).
+	 *
+	 * @param variant everything else that changes the result
+	 */
+	template<class Engine>
+	static Key key(const Engine &engine, const std::string &variant = std::string())
+	{
+		const unsigned int size = engine.getSize();
+
+		Key key;
+		key.add(size).add(engine.getCellSize()).add(variant);
+		key.add(static_cast<unsigned int>(engine.getKernel())).add(engine.getCflNumber());
+		key.add(engine.getBoundary(Boundary::Left)).add(engine.getBoundary(Boundary::Right));
+
+		// h, hu and the tracers without the ghost cells
+		std::vector<T> state;
+		engine.getState(state);
+		for (unsigned int i = 0; i < state.size(); i += size+2)
+			key.add(&state[i+1], size * sizeof(T));
+		key.add(engine.getBathymetry()+1, size * sizeof(T));
+		return key;
+	}
+
+	/**
+	 * Finds the latest cached state in (after, upTo]
+	 *
+	 * @param time output, time of the state
+	 * @return False if there is no such state
+	 */
+	bool latest(const Key &key, T after, T upTo, T &time) const
+	{
+		DIR *dir = opendir(directory(key).c_str());
+		if (!dir)
+			return false;
+
+		bool found = false;
+		while (struct dirent *entry = readdir(dir)) {
+			char *end;
+			T t = std::strtod(entry->d_name, &end);
+			if (end == entry->d_name || std::strcmp(end, ".state") != 0)
+				continue;
+
+			if (t > after && t <= upTo && (!found || t > time)) {
+				time = t;
+				found = true;
+			}
+		}
+		closedir(dir);
+
+		return found;
+	}
+
+	/**
+	 * Loads a state
+	 *
+	 * @param state output, has to have the size of the stored state
+	 *  (e.g. from the engine's getState())
+	 * @param steps output, number of time steps to this state
+	 * @return False if the state is missing or does not match the size
+	 */
+	bool load(const Key &key, T time, std::vector<T> &state, unsigned long &steps) const
+	{
+		std::ifstream in(fileName(key, time).c_str(), std::ios::binary);
+
+		Header header;
+		if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+				|| std::memcmp(header.magic, "SWE1DRC2", sizeof(header.magic)) != 0
+				|| header.length != state.size() || header.realSize != sizeof(T)
+				|| header.time != time)
+			return false;
+
+		if (!in.read(reinterpret_cast<char*>(&state[0]), state.size() * sizeof(T)))
+			return false;
+
+		steps = header.steps;
+		return true;
+	}
+
+	/**
+	 * Stores a state. The file is replaced atomically, so concurrent runs
+	 * of the same configuration never load a partial state.
+	 *
+	 * @param state e.g. from the engine's getState()
+	 */
+	void store(const Key &key, T time, unsigned long steps, const std::vector<T> &state) const
+	{
+		makeDirectory(directory(key));
+
+		Header header;
+		std::memcpy(header.magic, "SWE1DRC2", sizeof(header.magic));
+		header.length = state.size();
+		header.realSize = sizeof(T);
+		header.steps = steps;
+		header.time = time;
+
+		std::string file = fileName(key, time);
+		std::string tmpFile = file + ".tmp";
+		{
+			std::ofstream out(tmpFile.c_str(), std::ios::binary);
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			out.write(reinterpret_cast<const char*>(&state[0]), state.size() * sizeof(T));
+			if (!out)
+				throw std::runtime_error("Could not write " + tmpFile);
+		}
+		if (std::rename(tmpFile.c_str(), file.c_str()) != 0)
+			throw std::runtime_error("Could not rename " + tmpFile + ": " + strerror(errno));
+	}
+
+	const std::string& getDirectory() const
+	{
+		return m_directory;
+	}
+
+private:
+	std::string directory(const Key &key) const
+	{
+		return m_directory + '/' + key.str();
+	}
+
+	std::string fileName(const Key &key, T time) const
+	{
+		char buffer[64];
+		std::snprintf(buffer, sizeof(buffer), "/%a.state", static_cast<double>(time));
+		return directory(key) + buffer;
+	}
+
+	static void makeDirectory(const std::string &directory)
+	{
+		if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+			throw std::runtime_error("Could not create " + directory + ": " + strerror(errno));
+	}
+};
+
+}
+
+#endif /* TOOLS_RESULTCACHE_H_ */
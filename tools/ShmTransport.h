@@ -0,0 +1,261 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Transport between processes on the same node through a POSIX shared
+ *  memory segment.
+ *
+ *  Each rank owns one slot in the segment and only writes to its own slot.
+ *  A value is published by writing it and then storing an increasing
+ *  sequence number (release). The readers wait until the sequence number
+ *  of the other slot reaches their own. The values are double buffered:
+ *  a rank cannot get two messages ahead of a reader since it has to
+ *  receive from that reader first.
+ */
+
+#ifndef TOOLS_SHMTRANSPORT_H_
+#define TOOLS_SHMTRANSPORT_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "types.h"
+#include "Transport.h"
+
+namespace tools
+{
+
+class ShmTransport : public Transport
+{
+private:
+	struct Header
+	{
+		/** Set by rank 0 once the segment is initialized */
+		std::atomic<uint32_t> ready;
+		uint32_t numRanks;
+	};
+
+	struct alignas(64) Slot
+	{
+		std::atomic<uint64_t> haloSeq;
+		/** [buffer][left/right][value] */
+		T halo[2][2][HaloSize];
+
+		std::atomic<uint64_t> reduceSeq;
+		T reduceValue[2];
+	};
+
+	/** Busy waiting iterations before the process yields */
+	static const unsigned int spinsBeforeYield = 1000;
+
+	std::string m_name;
+	const unsigned int m_rank;
+	const unsigned int m_numRanks;
+
+	size_t m_segmentSize;
+	void *m_segment;
+	Header *m_header;
+	Slot *m_slots;
+
+	/** Number of halo exchanges and reductions started by this rank */
+	uint64_t m_haloSeq;
+	uint64_t m_reduceSeq;
+
+public:
+	/**
+	 * Attaches to the segment. Rank 0 creates it, the other ranks wait
+	 * until it exists.
+	 *
+	 * @param name name of the segment (e.g. "/swe1d-<pid>"), has to be
+	 *  unique for each run
+	 */
+	ShmTransport(const char* name, unsigned int rank, unsigned int numRanks)
+		: m_name(name), m_rank(rank), m_numRanks(numRanks),
+		  m_segmentSize(sizeof(Slot) * (numRanks + 1)),
+		  m_haloSeq(0), m_reduceSeq(0)
+	{
+		int fd;
+		if (rank == 0) {
+			// Remove leftovers of a crashed run
+			shm_unlink(name);
+			fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+			if (fd < 0 || ftruncate(fd, m_segmentSize) != 0)
+				throw std::runtime_error(std::string("Could not create ") + name + ": " + strerror(errno));
+		} else {
+			struct stat st;
+			while ((fd = shm_open(name, O_RDWR, 0600)) < 0
+					|| fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < m_segmentSize) {
+				if (fd >= 0)
+					close(fd);
+				sched_yield();
+			}
+		}
+
+		m_segment = mmap(0L, m_segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if (m_segment == MAP_FAILED)
+			throw std::runtime_error(std::string("Could not map ") + name + ": " + strerror(errno));
+
+		// The first slot holds the header (keeps the slots cache line aligned)
+		m_header = static_cast<Header*>(m_segment);
+		m_slots = static_cast<Slot*>(m_segment) + 1;
+
+		if (rank == 0) {
+			m_header->numRanks = numRanks;
+			m_header->ready.store(1, std::memory_order_release);
+		} else {
+			while (m_header->ready.load(std::memory_order_acquire) == 0)
+				sched_yield();
+			if (m_header->numRanks != numRanks)
+				throw std::runtime_error(std::string("Number of ranks does not match in ") + name);
+		}
+	}
+
+	/**
+	 * Detaches from the segment, rank 0 also removes its name
+	 */
+	~ShmTransport()
+	{
+		munmap(m_segment, m_segmentSize);
+		if (m_rank == 0)
+			shm_unlink(m_name.c_str());
+	}
+
+	unsigned int rank() const
+	{
+		return m_rank;
+	}
+
+	unsigned int numRanks() const
+	{
+		return m_numRanks;
+	}
+
+	void sendHalos(const T left[HaloSize], const T right[HaloSize])
+	{
+		m_haloSeq++;
+		Slot &slot = m_slots[m_rank];
+		std::memcpy(slot.halo[m_haloSeq & 1][0], left, sizeof(T) * HaloSize);
+		std::memcpy(slot.halo[m_haloSeq & 1][1], right, sizeof(T) * HaloSize);
+		slot.haloSeq.store(m_haloSeq, std::memory_order_release);
+	}
+
+	void receiveHalos(T left[HaloSize], T right[HaloSize])
+	{
+		if (m_rank > 0) {
+			Slot &slot = m_slots[m_rank-1];
+			waitFor(slot.haloSeq, m_haloSeq);
+			std::memcpy(left, slot.halo[m_haloSeq & 1][1], sizeof(T) * HaloSize);
+		}
+		if (m_rank < m_numRanks-1) {
+			Slot &slot = m_slots[m_rank+1];
+			waitFor(slot.haloSeq, m_haloSeq);
+			std::memcpy(right, slot.halo[m_haloSeq & 1][0], sizeof(T) * HaloSize);
+		}
+	}
+
+	T allReduceMax(T value)
+	{
+		publish(value);
+
+		T result = value;
+		for (unsigned int i = 0; i < m_numRanks; i++)
+			result = std::max(result, collect(i));
+		return result;
+	}
+
+	T allReduceSum(T value)
+	{
+		publish(value);
+
+		// Same order on all ranks
+		T result = 0;
+		for (unsigned int i = 0; i < m_numRanks; i++)
+			result += collect(i);
+		return result;
+	}
+
+	/**
+	 * Forks numRanks - 1 child processes
+	 *
+	 * @return The rank of the calling process (0 in the parent)
+	 */
+	static unsigned int forkRanks(unsigned int numRanks)
+	{
+		for (unsigned int rank = 1; rank < numRanks; rank++) {
+			pid_t pid = fork();
+			if (pid < 0)
+				throw std::runtime_error(std::string("Could not fork: ") + strerror(errno));
+			if (pid == 0)
+				return rank;
+		}
+
+		return 0;
+	}
+
+	/**
+	 * Waits for all child processes (call in rank 0 only)
+	 *
+	 * @return True if all of them exited successfully
+	 */
+	static bool waitRanks()
+	{
+		bool success = true;
+		int status;
+		while (wait(&status) > 0)
+			success &= WIFEXITED(status) && WEXITSTATUS(status) == 0;
+		return success;
+	}
+
+private:
+	void publish(T value)
+	{
+		m_reduceSeq++;
+		Slot &slot = m_slots[m_rank];
+		slot.reduceValue[m_reduceSeq & 1] = value;
+		slot.reduceSeq.store(m_reduceSeq, std::memory_order_release);
+	}
+
+	/**
+	 * @return The value of the current reduction published by rank
+	 */
+	T collect(unsigned int rank)
+	{
+		Slot &slot = m_slots[rank];
+		waitFor(slot.reduceSeq, m_reduceSeq);
+		return slot.reduceValue[m_reduceSeq & 1];
+	}
+
+	/**
+	 * Waits until seq reaches at least value
+	 */
+	static void waitFor(const std::atomic<uint64_t> &seq, uint64_t value)
+	{
+		unsigned int spins = 0;
+		while (seq.load(std::memory_order_acquire) < value) {
+			if (++spins > spinsBeforeYield)
+				sched_yield();
+		}
+	}
+
+	// Not copyable
+	ShmTransport(const ShmTransport&);
+	ShmTransport& operator=(const ShmTransport&);
+};
+
+}
+
+#endif /* TOOLS_SHMTRANSPORT_H_ */
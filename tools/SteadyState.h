@@ -0,0 +1,71 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Detects when a simulation has converged to a steady flow.
+ */
+
+#ifndef TOOLS_STEADYSTATE_H_
+#define TOOLS_STEADYSTATE_H_
+
+#include "types.h"
+
+namespace tools
+{
+
+class SteadyState
+{
+private:
+	/** Residual below which a time step counts as steady */
+	const T m_tolerance;
+	/** Number of consecutive steady time steps required */
+	const unsigned int m_window;
+	/** Number of consecutive time steps below the tolerance */
+	unsigned int m_count;
+
+public:
+	/**
+	 * @param tolerance residual below which a time step counts as steady
+	 * @param window number of consecutive steady time steps before the
+	 *  flow is considered converged
+	 */
+	SteadyState(T tolerance, unsigned int window)
+		: m_tolerance(tolerance), m_window(window), m_count(0)
+	{
+	}
+
+	/**
+	 * Feed the residual of the current time step.
+	 *
+	 * @param residual e.g. WavePropagation::getResidual()
+	 * @return True if the flow is steady
+	 */
+	bool update(T residual)
+	{
+		// Also resets on NaN
+		if (residual < m_tolerance)
+			m_count++;
+		else
+			m_count = 0;
+
+		return isSteady();
+	}
+
+	/**
+	 * @return True if the residual stayed below the tolerance for the
+	 *  whole window
+	 */
+	bool isSteady() const
+	{
+		return m_count >= m_window;
+	}
+
+	void reset()
+	{
+		m_count = 0;
+	}
+};
+
+}
+
+#endif /* TOOLS_STEADYSTATE_H_ */
@@ -0,0 +1,72 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Wall clock and time stamp counter timers.
+ */
+
+#ifndef TOOLS_TIMER_H_
+#define TOOLS_TIMER_H_
+
+#include <time.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SWE1D_HAVE_TSC 1
+#endif
+
+namespace tools
+{
+
+class Timer
+{
+public:
+	/**
+	 * @return Monotonic wall clock time in seconds
+	 */
+	static double now()
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return ts.tv_sec + ts.tv_nsec * 1e-9;
+	}
+
+	/**
+	 * @return Monotonic wall clock time in nanoseconds
+	 */
+	static uint64_t nowNs()
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+	}
+
+	/**
+	 * @return Time stamp counter (reference cycles), 0 if not available
+	 */
+	static uint64_t cycles()
+	{
+#ifdef SWE1D_HAVE_TSC
+		return __rdtsc();
+#else
+		return 0;
+#endif
+	}
+
+	/**
+	 * @return True if cycles() returns meaningful values
+	 */
+	static bool haveCycles()
+	{
+#ifdef SWE1D_HAVE_TSC
+		return true;
+#else
+		return false;
+#endif
+	}
+};
+
+}
+
+#endif /* TOOLS_TIMER_H_ */
@@ -0,0 +1,232 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Timeline of the time loop in the Chrome trace event format (open in
+ *  chrome://tracing or https://ui.perfetto.dev).
+ *
+ *  Compiled out unless SWE1D_TRACE is defined. At runtime, nothing is
+ *  recorded until Tracer::enable() is called. Each thread records into
+ *  its own preallocated buffer; events that do not fit are dropped and
+ *  counted.
+ *
+ *  Scopes inside parallel regions are recorded per thread, TRACE_BARRIER()
+ *  records the wait for the slowest thread.
+ */
+
+#ifndef TOOLS_TRACER_H_
+#define TOOLS_TRACER_H_
+
+#ifdef SWE1D_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <stdint.h>
+
+#include "Timer.h"
+
+namespace tools
+{
+
+class Tracer
+{
+public:
+	struct Event
+	{
+		/** Static string, only the pointer is stored */
+		const char* name;
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	/** Maximum number of threads that are recorded */
+	static const unsigned int maxThreads = 256;
+
+private:
+	struct alignas(64) ThreadBuffer
+	{
+		Event* events;
+		unsigned int capacity;
+		unsigned int size;
+		unsigned int dropped;
+	};
+
+	struct State
+	{
+		std::atomic<bool> enabled;
+		std::atomic<unsigned int> numThreads;
+		/** Capacity of new thread buffers */
+		unsigned int capacity;
+		/** Start of the trace */
+		uint64_t start;
+		std::string filename;
+		ThreadBuffer buffers[maxThreads];
+	};
+
+public:
+	/**
+	 * Start recording
+	 *
+	 * @param filename the trace is written to this file by flush()
+	 * @param capacity maximum number of events per thread (only used
+	 *  for threads that did not record anything yet)
+	 */
+	static void enable(const char* filename, unsigned int capacity = 1 << 20)
+	{
+		State &s = state();
+		s.filename = filename;
+		s.capacity = capacity;
+		s.start = Timer::nowNs();
+		s.enabled = true;
+	}
+
+	static bool enabled()
+	{
+		return state().enabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Record an event of the calling thread
+	 */
+	static void record(const char* name, uint64_t begin, uint64_t end)
+	{
+		ThreadBuffer &buffer = local();
+		if (buffer.size >= buffer.capacity) {
+			buffer.dropped++;
+			return;
+		}
+
+		Event &event = buffer.events[buffer.size++];
+		event.name = name;
+		event.begin = begin;
+		event.end = end;
+	}
+
+	/**
+	 * Write all recorded events and stop recording.
+	 * Must be called after all worker threads finished.
+	 */
+	static void flush()
+	{
+		State &s = state();
+		if (!s.enabled)
+			return;
+		s.enabled = false;
+
+		std::ofstream out(s.filename.c_str());
+		out << "{\"traceEvents\": [";
+
+		bool first = true;
+		unsigned int dropped = 0;
+		unsigned int numThreads = std::min(s.numThreads.load(), maxThreads);
+		for (unsigned int t = 0; t < numThreads; t++) {
+			ThreadBuffer &buffer = s.buffers[t];
+
+			for (unsigned int i = 0; i < buffer.size; i++) {
+				const Event &event = buffer.events[i];
+				// Complete event, times in microseconds
+				out << (first ? "\n" : ",\n")
+					<< "{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << t
+					<< ", \"ts\": " << (event.begin - s.start) * 1e-3
+					<< ", \"dur\": " << (event.end - event.begin) * 1e-3 << '}';
+				first = false;
+			}
+
+			dropped += buffer.dropped;
+			buffer.size = buffer.dropped = 0;
+		}
+
+		out << "\n], \"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_events\": " << dropped << "}}\n";
+	}
+
+private:
+	static State& state()
+	{
+		static State s;
+		return s;
+	}
+
+	static ThreadBuffer& local()
+	{
+		static thread_local ThreadBuffer* buffer = 0L;
+		if (__builtin_expect(!buffer, 0))
+			buffer = registerThread();
+		return *buffer;
+	}
+
+	static ThreadBuffer* registerThread()
+	{
+		State &s = state();
+		unsigned int id = s.numThreads.fetch_add(1);
+		if (id >= maxThreads) {
+			// Too many threads, these events are not recorded
+			static thread_local ThreadBuffer overflow = { 0L, 0, 0, 0 };
+			s.numThreads = maxThreads;
+			return &overflow;
+		}
+
+		// Allocated once per thread, never freed
+		ThreadBuffer &buffer = s.buffers[id];
+		buffer.events = new Event[s.capacity];
+		buffer.capacity = s.capacity;
+		buffer.size = buffer.dropped = 0;
+		return &buffer;
+	}
+};
+
+/**
+ * Records an event from construction until the end of the scope
+ */
+class TraceScope
+{
+private:
+	const char* const m_name;
+	const uint64_t m_begin;
+
+public:
+	TraceScope(const char* name)
+		: m_name(name), m_begin(Tracer::enabled() ? Timer::nowNs() : 0)
+	{
+	}
+
+	~TraceScope()
+	{
+		if (m_begin)
+			Tracer::record(m_name, m_begin, Timer::nowNs());
+	}
+};
+
+}
+
+#define SWE1D_TRACE_CONCAT_(a, b) a##b
+#define SWE1D_TRACE_CONCAT(a, b) SWE1D_TRACE_CONCAT_(a, b)
+
+/** Record the rest of the current scope (name must be a string literal) */
+#define TRACE_SCOPE(name) \
+	tools::TraceScope SWE1D_TRACE_CONCAT(traceScope, __LINE__)(name)
+/** Write the trace file */
+#define TRACE_FLUSH() tools::Tracer::flush()
+
+#ifdef _OPENMP
+/**
+ * Explicit barrier at the end of a parallel region, so the wait for the
+ * other threads is recorded (the implicit barrier is not visible). Must
+ * be reached by all threads of the team.
+ */
+#define TRACE_BARRIER() \
+	do { TRACE_SCOPE("barrier_wait"); _Pragma("omp barrier") } while (0)
+#else // _OPENMP
+#define TRACE_BARRIER() ((void) 0)
+#endif // _OPENMP
+
+#else // SWE1D_TRACE
+
+#define TRACE_SCOPE(name)
+#define TRACE_BARRIER() ((void) 0)
+#define TRACE_FLUSH() ((void) 0)
+
+#endif // SWE1D_TRACE
+
+#endif /* TOOLS_TRACER_H_ */
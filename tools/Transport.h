@@ -0,0 +1,72 @@
+/**
+ * @file
+ *  This file is part of SWE1D
+ *
+ *  Communication between the processes of a distributed simulation.
+ *
+ *  The ranks are ordered from left to right, each owns a contiguous slab
+ *  of cells. A backend only has to exchange one cell with each neighbour
+ *  and reduce a single value, e.g. with MPI:
+ *  - sendHalos(): MPI_Irecv from both neighbours, MPI_Isend to both
+ *  - receiveHalos(): MPI_Waitall
+ *  - allReduceMax(), allReduceSum(): MPI_Allreduce
+ */
+
+#ifndef TOOLS_TRANSPORT_H_
+#define TOOLS_TRANSPORT_H_
+
+#include "types.h"
+
+namespace tools
+{
+
+class Transport
+{
+public:
+	/** Values of one halo cell */
+	enum Halo {
+		HaloHeight,
+		HaloMomentum,
+		HaloBathymetry,
+		HaloSize
+	};
+
+	virtual ~Transport()
+	{
+	}
+
+	virtual unsigned int rank() const = 0;
+
+	virtual unsigned int numRanks() const = 0;
+
+	/**
+	 * Starts the halo exchange. Does not wait for the neighbours.
+	 *
+	 * @param left first cell of this rank, sent to the left neighbour
+	 * @param right last cell of this rank, sent to the right neighbour
+	 */
+	virtual void sendHalos(const T left[HaloSize], const T right[HaloSize]) = 0;
+
+	/**
+	 * Completes the halo exchange started with sendHalos(). Only the halos
+	 * of existing neighbours are set.
+	 *
+	 * @param left last cell of the left neighbour
+	 * @param right first cell of the right neighbour
+	 */
+	virtual void receiveHalos(T left[HaloSize], T right[HaloSize]) = 0;
+
+	/**
+	 * @return Maximum of value over all ranks (collective)
+	 */
+	virtual T allReduceMax(T value) = 0;
+
+	/**
+	 * @return Sum of value over all ranks, the same on all ranks (collective)
+	 */
+	virtual T allReduceSum(T value) = 0;
+};
+
+}
+
+#endif /* TOOLS_TRANSPORT_H_ */